@@ -1,5 +1,5 @@
-/* CP2130 class - Version 1.2.6
-   Copyright (c) 2021-2024 Samuel Lourenço
+/* CP2130 class - Version 1.3.0
+   Copyright (c) 2021-2026 Samuel Lourenço
 
    This library is free software: you can redistribute it and/or modify it
    under the terms of the GNU Lesser General Public License as published by
@@ -19,28 +19,103 @@
 
 
 // Includes
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <iomanip>
+#include <memory>
 #include <sstream>
+#include <thread>
 #include "cp2130.h"
 extern "C" {
 #include "libusb-extra.h"
 }
 
 // Definitions
-const unsigned int TR_TIMEOUT = 500;  // Transfer timeout in milliseconds
+const unsigned int TR_TIMEOUT = 500;  // Default transfer timeout in milliseconds (see setTransferPolicy())
+
+// Specific to the asynchronous transfer engine (added in version 1.3.0)
+const long EV_POLLPERIOD = 100000;  // Maximum period between checks for a stop request, in microseconds, while handling events
+const unsigned int EV_CANCELROUNDS = 4;  // Maximum number of times that pending transfers are cancelled and waited for, before being abandoned (see stopEventHandling())
+
+// Specific to spiWriteRead() (added in version 1.3.0)
+const size_t WR_PAYLOAD = 56;             // Maximum payload of each WriteRead command
+const size_t WR_PACKETSIZE = 64;          // Maximum packet size of the bulk IN endpoint
+const size_t WR_WINDOW = 4 * WR_PAYLOAD;  // Maximum amount of data, in bytes, that can be commanded ahead of the data being read back
+const size_t WR_INDEPTH = 4;              // Maximum number of queued bulk IN transfers
+
+// Specific to Batch and executeBatch() (added in version 1.3.0)
+const uint8_t OP_CONTROL = 0x00;  // Control transfer
+const uint8_t OP_BULK = 0x01;     // Bulk transfer
+const uint8_t OP_DELAY = 0x02;    // Delay
+
+// Specific to recordTransfer() and getStats() (added in version 1.3.0)
+const size_t ST_CALLS = 0;                                   // Index of the number of transfers, within each record of the statistics tables
+const size_t ST_BYTES = 1;                                   // Index of the number of bytes transferred
+const size_t ST_ERRORS = 2;                                  // Index of the number of failed transfers
+const size_t ST_TIMEOUTS = 3;                                // Index of the number of transfers that timed out
+const size_t ST_TOTALLAT = 4;                                // Index of the sum of all latencies
+const size_t ST_MAXLAT = 5;                                  // Index of the maximum latency
+const size_t ST_HISTOGRAM = 6;                               // Index of the first bin of the latency histogram
+const size_t ST_STRIDE = ST_HISTOGRAM + CP2130::STATS_BINS;  // Size of each record
+const size_t ST_RECORDS = 256;                               // Number of records of each table (one per request, or one per endpoint address)
+
+// Specific to trackRequest() (added in version 1.3.0)
+const uint16_t CS_ALLCHANNELS = 0x07ff;  // Bitmap covering the chip selects of all eleven channels
 
 // Specific to getDescGeneric() and writeDescGeneric() (added in version 1.1.0)
 const uint16_t DESC_TBLSIZE = 0x0040;          // Descriptor table size, including preamble [64]
 const size_t DESC_MAXIDX = DESC_TBLSIZE - 2;   // Maximum usable index [62]
 const size_t DESC_IDXINCR = DESC_TBLSIZE - 1;  // Index increment or step between table preambles [63]
 
+// Private procedure used to determine and cache both endpoint addresses, according to the transfer priority (added in version 1.3.0)
+// This costs a single "Get_USB_Config" request, unless the OTP ROM is cached (see getUSBConfig())
+void CP2130::cacheEndpoints(int &errcnt, std::string &errstr)
+{
+    int preverrcnt = errcnt;
+    uint8_t trfprio = getTransferPriority(errcnt, errstr);
+    if (errcnt == preverrcnt) {  // The addresses are only cached if the transfer priority was successfully retrieved
+        endpointInAddr_ = trfprio == PRIOWRITE ? 0x82 : 0x81;
+        endpointOutAddr_ = trfprio == PRIOWRITE ? 0x01 : 0x02;
+        endpointsCached_ = true;
+    }
+}
+
+// Private procedure used to claim the interface of a device that was just opened, and to complete its initialization (added as a refactor in version 1.3.0)
+int CP2130::claimDevice()
+{
+    int retval;
+    if (libusb_kernel_driver_active(handle_, 0) == 1) {  // If a kernel driver is active on the interface
+        libusb_detach_kernel_driver(handle_, 0);  // Detach the kernel driver
+        kernelWasAttached_ = true;  // Flag that the kernel driver was attached
+    } else {
+        kernelWasAttached_ = false;  // The kernel driver was not attached
+    }
+    if (libusb_claim_interface(handle_, 0) != 0) {  // Claim the interface. In case of failure
+        if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
+            libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
+        }
+        libusb_close(handle_);  // Close the device
+        handle_ = nullptr;  // Required to mark the device as closed
+        retval = ERROR_BUSY;
+    } else {
+        disconnected_ = false;  // Note that this flag is never assumed to be true for a device that was never opened - See constructor for details!
+        libusbTransport_.setHandle(handle_);
+        transport_ = &libusbTransport_;  // Synchronous transfers are carried out through the transport (implemented in version 1.3.0)
+        int errcnt = 0;
+        std::string errstr;
+        cacheEndpoints(errcnt, errstr);  // Cache both endpoint addresses (implemented in version 1.3.0) - Failing that, the addresses are determined on first use
+        retval = SUCCESS;
+    }
+    return retval;
+}
+
 // Private generic procedure used to get any descriptor (added as a refactor in version 1.1.0)
-std::u16string CP2130::getDescGeneric(uint8_t command, int &errcnt, std::string &errstr)
+void CP2130::getDescGeneric(uint8_t command, std::u16string &descriptor, int &errcnt, std::string &errstr)
 {
     unsigned char controlBufferIn[DESC_TBLSIZE];
-    controlTransfer(GET, command, 0x0000, 0x0000, controlBufferIn, DESC_TBLSIZE, errcnt, errstr);
-    std::u16string descriptor;
+    getPROMField(command, controlBufferIn, DESC_TBLSIZE, errcnt, errstr);  // Since version 1.3.0, the table is taken from the cached OTP ROM, if available
+    descriptor.clear();  // Since version 1.3.0, the descriptor is written to the given string, whose storage is reused if large enough
     size_t length = controlBufferIn[0];
     size_t end = length > DESC_MAXIDX ? DESC_MAXIDX : length;
     for (size_t i = 2; i < end; i += 2) {  // Process first 30 characters (bytes 2-61 of the array)
@@ -50,7 +125,7 @@ std::u16string CP2130::getDescGeneric(uint8_t command, int &errcnt, std::string
     }
     if ((command == GET_MANUFACTURING_STRING_1 || command == GET_PRODUCT_STRING_1) && length > DESC_MAXIDX) {
         char16_t midchar = controlBufferIn[DESC_MAXIDX];  // Char in the middle (parted between two tables)
-        controlTransfer(GET, command + 2, 0x0000, 0x0000, controlBufferIn, DESC_TBLSIZE, errcnt, errstr);
+        getPROMField(static_cast<uint8_t>(command + 2), controlBufferIn, DESC_TBLSIZE, errcnt, errstr);
         midchar = static_cast<char16_t>(controlBufferIn[0] << 8 | midchar);  // Reconstruct the char in the middle
         if (midchar != 0x0000) {  // Filter out the reconstructed char if the same is null
             descriptor += midchar;
@@ -62,7 +137,213 @@ std::u16string CP2130::getDescGeneric(uint8_t command, int &errcnt, std::string
             }
         }
     }
-    return descriptor;
+}
+
+// Private procedure used to get the data returned by a given request that reads an OTP ROM field (added in version 1.3.0)
+// The OTP ROM is read as a whole and cached first, if not cached already (see getPROMConfig()), so that the data is taken from the cached copy, laid out as returned by the CP2130
+// Thus, the getters of the OTP ROM fields are answered from a single read of the OTP ROM, and only the first one causes any transfers (getUSBConfig() is the exception, see there)
+void CP2130::getPROMField(uint8_t bRequest, unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr)
+{
+    size_t index = 0, size = 0;
+    switch (bRequest) {
+        case GET_USB_CONFIG:
+            index = PROMIDX_VID;  // The USB configuration fields are contiguous, and laid out as returned by the "Get_USB_Config" request
+            size = GET_USB_CONFIG_WLEN;
+            break;
+        case GET_MANUFACTURING_STRING_1:
+            index = PROMIDX_MANUFACTURING_STRING_1;
+            size = PROMSZE_MANUFACTURING_STRING_1;
+            break;
+        case GET_MANUFACTURING_STRING_2:
+            index = PROMIDX_MANUFACTURING_STRING_2;
+            size = PROMSZE_MANUFACTURING_STRING_2;
+            break;
+        case GET_PRODUCT_STRING_1:
+            index = PROMIDX_PRODUCT_STRING_1;
+            size = PROMSZE_PRODUCT_STRING_1;
+            break;
+        case GET_PRODUCT_STRING_2:
+            index = PROMIDX_PRODUCT_STRING_2;
+            size = PROMSZE_PRODUCT_STRING_2;
+            break;
+        case GET_SERIAL_STRING:
+            index = PROMIDX_SERIAL_STRING;
+            size = PROMSZE_SERIAL_STRING;
+            break;
+        case GET_PIN_CONFIG:
+            index = PROMIDX_PIN_CONFIG;
+            size = PROMSZE_PIN_CONFIG;
+            break;
+        case GET_LOCK_BYTE:
+            index = PROMIDX_LOCK_BYTE;
+            size = PROMSZE_LOCK_BYTE;
+            break;
+        default:
+            break;
+    }
+    if (size == 0 || size > wLength) {
+        controlTransfer(GET, bRequest, 0x0000, 0x0000, data, wLength, errcnt, errstr);
+    } else {
+        if (prom_.empty()) {
+            getPROMConfig(errcnt, errstr);
+        }
+        if (prom_.empty()) {  // The OTP ROM could not be read, and the error is already reported
+            std::fill(data, data + wLength, 0x00);
+        } else {
+            std::copy(prom_.begin() + index, prom_.begin() + index + size, data);
+            std::fill(data + size, data + wLength, 0x00);  // Any remaining bytes are not part of the field
+        }
+    }
+}
+
+// Private procedure that handles libusb events, run by the event handling thread (added in version 1.3.0)
+void CP2130::handleEvents()
+{
+    while (!stopEvents_) {
+        timeval tv = {0, EV_POLLPERIOD};
+        libusb_handle_events_timeout_completed(context_, &tv, nullptr);
+    }
+}
+
+// Private procedure that starts the event handling thread, if not already running (added in version 1.3.0)
+// If the context is shared, no thread is started, since events are handled by the owner of the context
+void CP2130::startEventHandling()
+{
+    if (ownsContext_ && !eventThread_.joinable()) {
+        stopEvents_ = false;
+        eventThread_ = std::thread(&CP2130::handleEvents, this);
+    }
+}
+
+// Private function that cancels any pending asynchronous transfers, and then stops the event handling thread (added in version 1.3.0)
+// Transfers whose cancellation is not reported within a few rounds, as happens with a shared context whose events are not being handled, are abandoned, and freed if they ever complete
+// Returns false, without doing anything, if called from a callback, since that callback would be waited for from within itself, and the event handling thread would be joined from itself
+bool CP2130::stopEventHandling()
+{
+    bool stopped = false;
+    if (callbackThread_.load() != std::this_thread::get_id() && eventThread_.get_id() != std::this_thread::get_id()) {
+        std::unique_lock<std::mutex> lock(asyncMutex_);
+        for (unsigned int round = 0; !pendingTransfers_.empty() && round < EV_CANCELROUNDS; ++round) {  // Cancellation is repeated, in order to catch any transfers that might be resubmitted by a callback in the meantime
+            for (std::set<libusb_transfer *>::iterator it = pendingTransfers_.begin(); it != pendingTransfers_.end(); ++it) {
+                libusb_cancel_transfer(*it);
+            }
+            asyncCondition_.wait_for(lock, std::chrono::milliseconds(TR_TIMEOUT));  // Wait for the cancellations to be reported by the event handling thread (or by the owner of the context, if shared)
+        }
+        for (std::set<libusb_transfer *>::iterator it = pendingTransfers_.begin(); it != pendingTransfers_.end();) {
+            if (!static_cast<AsyncTransfer *>((*it)->user_data)->claimed.exchange(true)) {  // The transfer is abandoned, unless its callback is already running
+                it = pendingTransfers_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        asyncCondition_.wait(lock, [this] {  // Any callbacks that are already running are waited for, since they access this object
+            return pendingTransfers_.empty();
+        });
+        lock.unlock();
+        if (eventThread_.joinable()) {
+            stopEvents_ = true;
+            eventThread_.join();
+        }
+        stopped = true;
+    }
+    return stopped;
+}
+
+// Private procedure used to open the device having the given VID, PID and, optionally, serial number, once the context is set (added as a refactor in version 1.3.0)
+int CP2130::openDevice(uint16_t vid, uint16_t pid, const std::string &serial)
+{
+    int retval;
+    if (serial.empty()) {  // Note that serial, by omission, is an empty string
+        handle_ = libusb_open_device_with_vid_pid(context_, vid, pid);  // If no serial number is specified, this will open the first device found with matching VID and PID
+    } else {
+        char *serialcstr = new char[serial.size() + 1];  // Allocated dynamically since version 1.1.0
+        std::strcpy(serialcstr, serial.c_str());
+        handle_ = libusb_open_device_with_vid_pid_serial(context_, vid, pid, reinterpret_cast<unsigned char *>(serialcstr));
+        delete[] serialcstr;
+    }
+    if (handle_ == nullptr) {  // If the previous operation fails to get a device handle
+        retval = ERROR_NOT_FOUND;
+    } else {  // If the device is successfully opened and a handle obtained
+        retval = claimDevice();
+    }
+    return retval;
+}
+
+// Private procedure used to open the device having the given VID, PID, bus number and port path, once the context is set (added in version 1.3.0)
+int CP2130::openDevice(uint16_t vid, uint16_t pid, uint8_t bus, const std::vector<uint8_t> &ports)
+{
+    int retval;
+    handle_ = libusb_open_device_with_vid_pid_path(context_, vid, pid, bus, ports.data(), static_cast<int>(ports.size()));  // Only the matching device is opened
+    if (handle_ == nullptr) {  // If the previous operation fails to get a device handle
+        retval = ERROR_NOT_FOUND;
+    } else {  // If the device is successfully opened and a handle obtained
+        retval = claimDevice();
+    }
+    return retval;
+}
+
+// Private procedure used to account for a completed transfer, if statistics are enabled (added in version 1.3.0)
+void CP2130::recordTransfer(bool control, uint8_t index, int bytes, bool failed, bool timedOut, const std::chrono::steady_clock::time_point &start)
+{
+    uint64_t latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    size_t bin = 0;
+    while (bin < STATS_BINS - 1 && latency >= static_cast<uint64_t>(2) << bin) {
+        ++bin;
+    }
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    std::vector<uint64_t> &table = control ? controlStats_ : bulkStats_;
+    if (table.empty()) {
+        table.resize(ST_RECORDS * ST_STRIDE);  // The tables are only allocated once statistics are in use, and never shrink
+    }
+    uint64_t *record = table.data() + ST_STRIDE * index;
+    ++record[ST_CALLS];
+    if (bytes > 0) {
+        record[ST_BYTES] += static_cast<uint64_t>(bytes);
+    }
+    if (failed) {
+        ++record[ST_ERRORS];
+    }
+    if (timedOut) {
+        ++record[ST_TIMEOUTS];
+    }
+    record[ST_TOTALLAT] += latency;
+    record[ST_MAXLAT] = std::max(record[ST_MAXLAT], latency);
+    ++record[ST_HISTOGRAM + bin];
+}
+
+// Private procedure used to keep track of the chip select state and of the validity of the cached OTP ROM, given a control request and its data stage (added in version 1.3.0)
+// Only the chip selects set by a successful "Set_GPIO_Chip_Select" request become known, while any other outcome that may affect them causes all of them to become unknown
+// Likewise, any request that writes to the OTP ROM discards the cached copy, whether it succeeds or not (see getPROMConfig())
+void CP2130::trackRequest(uint8_t bmRequestType, uint8_t bRequest, const unsigned char *data, uint16_t wLength, bool succeeded)
+{
+    if (bmRequestType == SET && bRequest == SET_GPIO_CHIP_SELECT) {
+        if (!succeeded || data == nullptr || wLength != SET_GPIO_CHIP_SELECT_WLEN || data[0] > 10) {
+            csKnown_ = 0x0000;
+        } else {
+            uint16_t bitmap = static_cast<uint16_t>(0x0001 << data[0]);
+            if (data[1] == 0x00) {  // Corresponding chip select disabled
+                csKnown_ = static_cast<uint16_t>(csKnown_ | bitmap);
+                csState_ = static_cast<uint16_t>(csState_ & ~bitmap);
+            } else if (data[1] == 0x01) {  // Corresponding chip select enabled
+                csKnown_ = static_cast<uint16_t>(csKnown_ | bitmap);
+                csState_ = static_cast<uint16_t>(csState_ | bitmap);
+            } else if (data[1] == 0x02) {  // Only the corresponding chip select is enabled, all the others are disabled
+                csKnown_ = CS_ALLCHANNELS;
+                csState_ = bitmap;
+            } else {
+                csKnown_ = 0x0000;
+            }
+        }
+    } else if (bmRequestType == GET && bRequest == GET_GPIO_CHIP_SELECT) {
+        if (succeeded && data != nullptr && wLength == GET_GPIO_CHIP_SELECT_WLEN) {  // The state of every chip select is read back
+            csKnown_ = CS_ALLCHANNELS;
+            csState_ = static_cast<uint16_t>(CS_ALLCHANNELS & (data[0] << 8 | data[1]));
+        }
+    } else if (bmRequestType == SET && (bRequest == RESET_DEVICE || bRequest == SET_GPIO_MODE_AND_LEVEL)) {  // A reset or a change of pin mode may affect any chip select
+        csKnown_ = 0x0000;
+    } else if (bmRequestType == SET && (bRequest == SET_USB_CONFIG || bRequest == SET_MANUFACTURING_STRING_1 || bRequest == SET_MANUFACTURING_STRING_2 || bRequest == SET_PRODUCT_STRING_1 || bRequest == SET_PRODUCT_STRING_2 || bRequest == SET_SERIAL_STRING || bRequest == SET_PIN_CONFIG || bRequest == SET_LOCK_BYTE || bRequest == SET_PROM_CONFIG)) {
+        prom_.clear();
+    }
 }
 
 // Private generic procedure used to write any descriptor (added as a refactor in version 1.1.0)
@@ -88,6 +369,102 @@ void CP2130::writeDescGeneric(const std::u16string &descriptor, uint8_t command,
     }
 }
 
+// Private static procedure that is called by libusb when an asynchronous transfer completes (added in version 1.3.0)
+void LIBUSB_CALL CP2130::asyncCallback(libusb_transfer *transfer)
+{
+    AsyncTransfer *record = static_cast<AsyncTransfer *>(transfer->user_data);
+    if (!record->claimed.exchange(true)) {  // Otherwise, the transfer was abandoned by stopEventHandling(), and its owner may no longer exist (implemented in version 1.3.0)
+        CP2130 *owner = record->owner;
+        if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
+            owner->disconnected_ = true;  // This reports that the device has been disconnected
+        }
+        if (record->submitted != std::chrono::steady_clock::time_point()) {  // Only set if statistics were enabled at submission time (implemented in version 1.3.0)
+            owner->recordTransfer(record->control, record->statsIndex, transfer->actual_length, transfer->status != LIBUSB_TRANSFER_COMPLETED, transfer->status == LIBUSB_TRANSFER_TIMED_OUT, record->submitted);
+        }
+        if (record->destination != nullptr && transfer->actual_length > 0) {  // The data stage of a device-to-host control transfer is delivered before the callback is invoked (implemented in version 1.3.0)
+            std::copy(record->buffer.begin() + LIBUSB_CONTROL_SETUP_SIZE, record->buffer.begin() + LIBUSB_CONTROL_SETUP_SIZE + transfer->actual_length, record->destination);
+        }
+        if (record->callback) {
+            owner->callbackThread_ = std::this_thread::get_id();  // Lets stopEventHandling() refuse to be called from the callback
+            record->callback(transfer->status, transfer->actual_length);
+            owner->callbackThread_ = std::thread::id();
+        }
+        delete record;
+        {
+            std::lock_guard<std::mutex> lock(owner->asyncMutex_);
+            owner->pendingTransfers_.erase(transfer);
+            owner->asyncCondition_.notify_all();  // Notified while holding the mutex, since stopEventHandling() may return, and the object may be destroyed, as soon as the mutex is released
+        }
+    } else {
+        delete record;
+    }
+    libusb_free_transfer(transfer);  // The object must not be accessed from this point on
+}
+
+// Private static function that checks if the given device has the given VID and PID, in which case it is opened in order to write its serial number to the given string, whose storage is reused (added in version 1.3.0)
+// Returns true if the device matches and could be opened, and the serial number is left empty if it could not be retrieved
+bool CP2130::readDeviceSerial(libusb_device *device, uint16_t vid, uint16_t pid, std::string &serial)
+{
+    bool matched = false;
+    libusb_device_descriptor desc;
+    if (libusb_get_device_descriptor(device, &desc) == 0 && desc.idVendor == vid && desc.idProduct == pid) {  // If the device descriptor is retrieved, and both VID and PID correspond to the respective given values
+        libusb_device_handle *handle;
+        if (libusb_open(device, &handle) == 0) {  // Open the listed device. If successfull
+            unsigned char str_desc[256];
+            int length = libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, str_desc, static_cast<int>(sizeof(str_desc)));  // Get the serial number string in ASCII format
+            libusb_close(handle);  // Close the device
+            serial.assign(reinterpret_cast<char *>(str_desc), static_cast<size_t>(length < 0 ? 0 : length));
+            matched = true;
+        }
+    }
+    return matched;
+}
+
+// Private static function that checks if a transfer that failed with the given result can be retried (added in version 1.3.0)
+// A device that is gone is never retried, while a timeout, a stall or an I/O error may be caused by a busy bus, and often clears up on a subsequent attempt
+bool CP2130::isRetryable(int result)
+{
+    return result == LIBUSB_ERROR_TIMEOUT || result == LIBUSB_ERROR_PIPE || result == LIBUSB_ERROR_IO || result == LIBUSB_ERROR_INTERRUPTED;
+}
+
+// Private static function that returns the transfer class of the given control request (added in version 1.3.0)
+uint8_t CP2130::transferClass(uint8_t bRequest)
+{
+    return bRequest >= GET_USB_CONFIG && bRequest <= SET_PROM_CONFIG ? TRANSFERS_PROM : TRANSFERS_CONTROL;
+}
+
+// Private static function that converts a value returned by a transport into the corresponding transfer status, as passed to callbacks (added in version 1.3.0)
+int CP2130::transferStatus(int result)
+{
+    int status;
+    if (result >= 0) {
+        status = LIBUSB_TRANSFER_COMPLETED;
+    } else if (result == LIBUSB_ERROR_TIMEOUT) {
+        status = LIBUSB_TRANSFER_TIMED_OUT;
+    } else if (result == LIBUSB_ERROR_PIPE) {
+        status = LIBUSB_TRANSFER_STALL;
+    } else if (result == LIBUSB_ERROR_NO_DEVICE) {
+        status = LIBUSB_TRANSFER_NO_DEVICE;
+    } else if (result == LIBUSB_ERROR_OVERFLOW) {
+        status = LIBUSB_TRANSFER_OVERFLOW;
+    } else {
+        status = LIBUSB_TRANSFER_ERROR;
+    }
+    return status;
+}
+
+// "Equal to" operator for DeviceRecord
+bool CP2130::DeviceRecord::operator ==(const CP2130::DeviceRecord &other) const
+{
+    return vid == other.vid && pid == other.pid && bus == other.bus && ports == other.ports && serial == other.serial;
+}
+
+// "Not equal to" operator for DeviceRecord
+bool CP2130::DeviceRecord::operator !=(const CP2130::DeviceRecord &other) const
+{
+    return !(operator ==(other));
+}
+
 // "Equal to" operator for EventCounter
 bool CP2130::EventCounter::operator ==(const CP2130::EventCounter &other) const
 {
@@ -100,6 +477,18 @@ bool CP2130::EventCounter::operator !=(const CP2130::EventCounter &other) const
     return !(operator ==(other));
 }
 
+// "Equal to" operator for Metrics
+bool CP2130::Metrics::operator ==(const CP2130::Metrics &other) const
+{
+    return calls == other.calls && bytes == other.bytes && errors == other.errors && timeouts == other.timeouts && totalLatency == other.totalLatency && maxLatency == other.maxLatency && std::equal(histogram, histogram + STATS_BINS, other.histogram);
+}
+
+// "Not equal to" operator for Metrics
+bool CP2130::Metrics::operator !=(const CP2130::Metrics &other) const
+{
+    return !(operator ==(other));
+}
+
 // "Equal to" operator for PinConfig
 bool CP2130::PinConfig::operator ==(const CP2130::PinConfig &other) const
 {
@@ -184,6 +573,87 @@ bool CP2130::SPIMode::operator !=(const CP2130::SPIMode &other) const
     return !(operator ==(other));
 }
 
+// "Equal to" operator for Stats
+bool CP2130::Stats::operator ==(const CP2130::Stats &other) const
+{
+    return control == other.control && bulk == other.bulk;
+}
+
+// "Not equal to" operator for Stats
+bool CP2130::Stats::operator !=(const CP2130::Stats &other) const
+{
+    return !(operator ==(other));
+}
+
+// "Equal to" operator for Status
+bool CP2130::Status::operator ==(const CP2130::Status &other) const
+{
+    return code == other.code && result == other.result && (function == other.function || (function != nullptr && other.function != nullptr && std::strcmp(function, other.function) == 0)) && (detail == other.detail || (detail != nullptr && other.detail != nullptr && std::strcmp(detail, other.detail) == 0)) && bmRequestType == other.bmRequestType && bRequest == other.bRequest && endpointAddr == other.endpointAddr;
+}
+
+// "Not equal to" operator for Status
+bool CP2130::Status::operator !=(const CP2130::Status &other) const
+{
+    return !(operator ==(other));
+}
+
+// Formats the status as an error message, identical to the one appended to "errstr" by the corresponding function (an empty string is returned if successful)
+// This is the only place where text is produced, so that the functions returning a Status never touch strings
+std::string CP2130::Status::message() const
+{
+    std::ostringstream stream;
+    if (code == STATUS_NOT_OPEN) {
+        stream << "In " << function << "(): device is not open." << std::endl;
+    } else if (code == STATUS_INVALID_ARGUMENT) {
+        stream << "In " << function << "(): " << detail << std::endl;
+    } else if (code == STATUS_CONTROL_FAILED) {
+        stream << "Failed control transfer (0x"
+               << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(bmRequestType)
+               << ", 0x"
+               << std::setw(2) << static_cast<int>(bRequest)
+               << ")." << std::endl;
+    } else if (code == STATUS_BULK_FAILED) {
+        if (endpointAddr < 0x80) {
+            stream << "Failed bulk OUT transfer to endpoint "
+                   << (0x0f & endpointAddr)
+                   << " (address 0x"
+                   << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(endpointAddr)
+                   << ")." << std::endl;
+        } else {
+            stream << "Failed bulk IN transfer from endpoint "
+                   << (0x0f & endpointAddr)
+                   << " (address 0x"
+                   << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(endpointAddr)
+                   << ")." << std::endl;
+        }
+    }
+    return stream.str();
+}
+
+// "Equal to" operator for TransferPolicy
+bool CP2130::TransferPolicy::operator ==(const CP2130::TransferPolicy &other) const
+{
+    return timeout == other.timeout && retries == other.retries && backoff == other.backoff;
+}
+
+// "Not equal to" operator for TransferPolicy
+bool CP2130::TransferPolicy::operator !=(const CP2130::TransferPolicy &other) const
+{
+    return !(operator ==(other));
+}
+
+// "Equal to" operator for TransferResult
+bool CP2130::TransferResult::operator ==(const CP2130::TransferResult &other) const
+{
+    return status == other.status && transferred == other.transferred && data == other.data;
+}
+
+// "Not equal to" operator for TransferResult
+bool CP2130::TransferResult::operator !=(const CP2130::TransferResult &other) const
+{
+    return !(operator ==(other));
+}
+
 // "Equal to" operator for USBConfig
 bool CP2130::USBConfig::operator ==(const CP2130::USBConfig &other) const
 {
@@ -196,11 +666,264 @@ bool CP2130::USBConfig::operator !=(const CP2130::USBConfig &other) const
     return !(operator ==(other));
 }
 
+CP2130::Batch::Batch() :
+    operations_()
+{
+}
+
+// Checks if the batch is empty (added in version 1.3.0)
+bool CP2130::Batch::empty() const
+{
+    return operations_.empty();
+}
+
+// Returns the number of operations recorded in the batch, including delays (added in version 1.3.0)
+size_t CP2130::Batch::size() const
+{
+    return operations_.size();
+}
+
+// Records a bulk OUT transfer of the given data (added in version 1.3.0)
+void CP2130::Batch::bulkWrite(uint8_t endpointOutAddr, const std::vector<uint8_t> &data)
+{
+    Operation operation = {OP_BULK, 0x00, 0x00, 0x0000, 0x0000, endpointOutAddr, 0, data};
+    operations_.push_back(operation);
+}
+
+// Discards all operations recorded in the batch (added in version 1.3.0)
+void CP2130::Batch::clear()
+{
+    operations_.clear();
+}
+
+// Records the configuration of delays for a given SPI channel (added in version 1.3.0)
+void CP2130::Batch::configureSPIDelays(uint8_t channel, const SPIDelays &delays, int &errcnt, std::string &errstr)
+{
+    if (channel > 10) {
+        ++errcnt;
+        errstr += "In Batch::configureSPIDelays(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> controlBufferOut = {
+            channel,                                                                                                     // Selected channel
+            static_cast<uint8_t>(delays.cstglen << 3 | delays.prdasten << 2 | delays.pstasten << 1 | (delays.itbyten)),  // SPI enable mask (chip select toggle, pre-deassert, post-assert and inter-byte delay enable bits)
+            static_cast<uint8_t>(delays.itbytdly >> 8), static_cast<uint8_t>(delays.itbytdly),                           // Inter-byte delay
+            static_cast<uint8_t>(delays.pstastdly >> 8), static_cast<uint8_t>(delays.pstastdly),                         // Post-assert delay
+            static_cast<uint8_t>(delays.prdastdly >> 8), static_cast<uint8_t>(delays.prdastdly)                          // Pre-deassert delay
+        };
+        controlWrite(SET_SPI_DELAY, 0x0000, 0x0000, controlBufferOut);
+    }
+}
+
+// Records the configuration of the given SPI channel in respect to its chip select mode, clock frequency, polarity and phase (added in version 1.3.0)
+void CP2130::Batch::configureSPIMode(uint8_t channel, const SPIMode &mode, int &errcnt, std::string &errstr)
+{
+    if (channel > 10) {
+        ++errcnt;
+        errstr += "In Batch::configureSPIMode(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> controlBufferOut = {
+            channel,                                                                                       // Selected channel
+            static_cast<uint8_t>(mode.cpha << 5 | mode.cpol << 4 | mode.csmode << 3 | (0x07 & mode.cfrq))  // Control word (specified chip select mode, clock frequency, polarity and phase)
+        };
+        controlWrite(SET_SPI_WORD, 0x0000, 0x0000, controlBufferOut);
+    }
+}
+
+// Records a host-to-device vendor request, along with its data stage (added in version 1.3.0)
+void CP2130::Batch::controlWrite(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const std::vector<uint8_t> &data)
+{
+    Operation operation = {OP_CONTROL, SET, bRequest, wValue, wIndex, 0x00, 0, data};
+    operations_.push_back(operation);
+}
+
+// Records a delay, which is applied after all previous operations complete (added in version 1.3.0)
+// This is required, for instance, when the LTC2640 DAC needs time to settle after its chip select is enabled (see FAU201Device::setVoltage())
+void CP2130::Batch::delay(unsigned int microseconds)
+{
+    Operation operation = {OP_DELAY, 0x00, 0x00, 0x0000, 0x0000, 0x00, microseconds, std::vector<uint8_t>()};
+    operations_.push_back(operation);
+}
+
+// Records the disabling of the chip select of the target channel (added in version 1.3.0)
+void CP2130::Batch::disableCS(uint8_t channel, int &errcnt, std::string &errstr)
+{
+    if (channel > 10) {
+        ++errcnt;
+        errstr += "In Batch::disableCS(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> controlBufferOut = {
+            channel,  // Selected channel
+            0x00      // Corresponding chip select disabled
+        };
+        controlWrite(SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut);
+    }
+}
+
+// Records the disabling of all SPI delays for a given channel (added in version 1.3.0)
+void CP2130::Batch::disableSPIDelays(uint8_t channel, int &errcnt, std::string &errstr)
+{
+    if (channel > 10) {
+        ++errcnt;
+        errstr += "In Batch::disableSPIDelays(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> controlBufferOut = {
+            channel,     // Selected channel
+            0x00,        // All SPI delays disabled, no CS toggle
+            0x00, 0x00,  // Inter-byte,
+            0x00, 0x00,  // post-assert and
+            0x00, 0x00   // pre-deassert delays all set to 0us
+        };
+        controlWrite(SET_SPI_DELAY, 0x0000, 0x0000, controlBufferOut);
+    }
+}
+
+// Records the enabling of the chip select of the target channel (added in version 1.3.0)
+void CP2130::Batch::enableCS(uint8_t channel, int &errcnt, std::string &errstr)
+{
+    if (channel > 10) {
+        ++errcnt;
+        errstr += "In Batch::enableCS(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> controlBufferOut = {
+            channel,  // Selected channel
+            0x01      // Corresponding chip select enabled
+        };
+        controlWrite(SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut);
+    }
+}
+
+// Records the enabling of the chip select of the target channel, disabling any others (added in version 1.3.0)
+void CP2130::Batch::selectCS(uint8_t channel, int &errcnt, std::string &errstr)
+{
+    if (channel > 10) {
+        ++errcnt;
+        errstr += "In Batch::selectCS(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> controlBufferOut = {
+            channel,  // Selected channel
+            0x02      // Only the corresponding chip select is enabled, all the others are disabled
+        };
+        controlWrite(SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut);
+    }
+}
+
+// Records the setting of the GPIO pins selected by the given mask to the given values, in bitmap format (added in version 1.3.0)
+void CP2130::Batch::setGPIOs(uint16_t bmValues, uint16_t bmMask)
+{
+    std::vector<uint8_t> controlBufferOut = {
+        static_cast<uint8_t>((BMGPIOS & bmValues) >> 8), static_cast<uint8_t>(BMGPIOS & bmValues),  // GPIO values bitmap
+        static_cast<uint8_t>((BMGPIOS & bmMask) >> 8), static_cast<uint8_t>(BMGPIOS & bmMask)       // Mask bitmap
+    };
+    controlWrite(SET_GPIO_VALUES, 0x0000, 0x0000, controlBufferOut);
+}
+
+// Records a write to the SPI bus, using the given data (added in version 1.3.0)
+void CP2130::Batch::spiWrite(const uint8_t *data, size_t size, uint8_t endpointOutAddr)
+{
+    uint32_t bytesToWrite = static_cast<uint32_t>(size);
+    std::vector<uint8_t> writeCommandBuffer(size + 8);
+    writeCommandBuffer[0] = 0x00;           // Reserved
+    writeCommandBuffer[1] = 0x00;           // Reserved
+    writeCommandBuffer[2] = CP2130::WRITE;  // Write command
+    writeCommandBuffer[3] = 0x00;           // Reserved
+    writeCommandBuffer[4] = static_cast<uint8_t>(bytesToWrite);
+    writeCommandBuffer[5] = static_cast<uint8_t>(bytesToWrite >> 8);
+    writeCommandBuffer[6] = static_cast<uint8_t>(bytesToWrite >> 16);
+    writeCommandBuffer[7] = static_cast<uint8_t>(bytesToWrite >> 24);
+    std::copy(data, data + size, writeCommandBuffer.begin() + 8);
+    bulkWrite(endpointOutAddr, writeCommandBuffer);
+}
+
+// Records a write to the SPI bus, using the given vector (added in version 1.3.0)
+void CP2130::Batch::spiWrite(const std::vector<uint8_t> &data, uint8_t endpointOutAddr)
+{
+    spiWrite(data.data(), data.size(), endpointOutAddr);
+}
+
+#ifdef CP2130_COROUTINES
+// The state is value-initialized, so that the transfer is not yet done (added in version 1.3.0)
+CP2130::TransferAwaitable::TransferAwaitable() :
+    state_(std::make_shared<State>())
+{
+}
+
+// Checks if the transfer already completed, in which case the awaiting coroutine is not suspended (added in version 1.3.0)
+bool CP2130::TransferAwaitable::await_ready() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->done;
+}
+
+// Returns a callback that completes the awaitable, and resumes the awaiting coroutine, if suspended, from the thread that invokes the callback (added in version 1.3.0)
+// Only the first invocation has any effect
+CP2130::TransferCallback CP2130::TransferAwaitable::callback() const
+{
+    std::shared_ptr<State> state = state_;
+    return [state](int status, int transferred) {
+        std::coroutine_handle<> handle;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->done) {
+                state->done = true;
+                state->result.status = status;
+                state->result.transferred = transferred;
+                handle = state->handle;
+            }
+        }
+        if (handle) {
+            handle.resume();  // The lock is released first, since the coroutine may go on to await another transfer
+        }
+    };
+}
+
+// Returns the result of the transfer, once completed (added in version 1.3.0)
+CP2130::TransferResult CP2130::TransferAwaitable::await_resume()
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->result;
+}
+
+// Registers the given coroutine to be resumed once the transfer completes, returning false if it already did, so that the coroutine carries on without being suspended (added in version 1.3.0)
+// This covers transfers that complete between await_ready() and this call, as well as the ones that are carried out synchronously, through a transport other than libusb
+bool CP2130::TransferAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    bool suspend = !state_->done;
+    if (suspend) {
+        state_->handle = handle;
+    }
+    return suspend;
+}
+#endif
+
 CP2130::CP2130() :
     context_(nullptr),
     handle_(nullptr),
+    libusbTransport_(),
+    transport_(nullptr),
     disconnected_(false),
-    kernelWasAttached_(false)
+    kernelWasAttached_(false),
+    endpointsCached_(false),
+    ownsContext_(false),
+    endpointInAddr_(0x00),
+    endpointOutAddr_(0x00),
+    csKnown_(0x0000),
+    csState_(0x0000),
+    prom_(),
+    eventThread_(),
+    callbackThread_(std::thread::id()),
+    stopEvents_(false),
+    asyncMutex_(),
+    asyncCondition_(),
+    pendingTransfers_(),
+    scratch_(),
+    statsEnabled_(false),
+    statsMutex_(),
+    controlStats_(),
+    bulkStats_(),
+    timeouts_{TR_TIMEOUT, TR_TIMEOUT, TR_TIMEOUT},
+    backoffs_{0, 0, 0},
+    retries_{0, 0, 0}  // By default, transfers are not retried, as in previous versions
 {
 }
 
@@ -218,52 +941,214 @@ bool CP2130::disconnected() const
 // Checks if the device is open
 bool CP2130::isOpen() const
 {
-    return handle_ != nullptr;  // Returns true if the device is open, or false otherwise
+    return transport_ != nullptr;  // Returns true if the device is open, or false otherwise (since version 1.3.0, this also applies to devices opened through a transport)
+}
+
+// Checks if statistics are enabled (added in version 1.3.0)
+bool CP2130::isStatsEnabled() const
+{
+    return statsEnabled_;
+}
+
+// Reads asynchronously from the given bulk IN endpoint, returning a future that holds the result (added in version 1.3.0)
+std::future<CP2130::TransferResult> CP2130::bulkReadAsync(uint8_t endpointInAddr, int length, int &errcnt, std::string &errstr)
+{
+    std::shared_ptr<std::vector<uint8_t>> buffer = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(length < 0 ? 0 : length));
+    std::shared_ptr<std::promise<TransferResult>> promise = std::make_shared<std::promise<TransferResult>>();
+    std::future<TransferResult> future = promise->get_future();
+    int preverrcnt = errcnt;
+    bulkTransferAsync(endpointInAddr, buffer->data(), length, [buffer, promise](int status, int transferred) {
+        TransferResult result;
+        result.status = status;
+        result.transferred = transferred;
+        result.data.swap(*buffer);  // The buffer is no longer needed, so its contents can be moved instead of copied
+        result.data.resize(static_cast<size_t>(transferred));
+        promise->set_value(result);
+    }, errcnt, errstr);
+    if (errcnt != preverrcnt) {  // If the transfer could not be submitted, the future is fulfilled right away
+        promise->set_value(TransferResult{LIBUSB_TRANSFER_ERROR, 0, std::vector<uint8_t>()});
+    }
+    return future;
+}
+
+// Safe bulk transfer, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+// This function neither allocates memory nor touches strings, so it is suitable for hot loops (see Status::message() for getting the corresponding error message)
+// Since version 1.3.0, failed attempts are retried as per the policy of TRANSFERS_BULK (see setTransferPolicy())
+CP2130::Status CP2130::bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred)
+{
+    Status status = {STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (!isOpen()) {
+        status.code = STATUS_NOT_OPEN;  // Program logic error
+        status.function = "bulkTransfer";
+    } else {
+        bool instrumented = statsEnabled_.load(std::memory_order_relaxed);  // When statistics are disabled, this is the only added cost
+        int done = 0;  // Number of bytes transferred so far, since a retry resumes where the failed attempt stopped (implemented in version 1.3.0)
+        int result;
+        bool retry;
+        uint8_t attempt = 0;
+        do {
+            std::chrono::steady_clock::time_point start;
+            if (instrumented) {
+                start = std::chrono::steady_clock::now();
+            }
+            int count = 0;
+            result = transport_->bulkTransfer(endpointAddr, data + done, length - done, &count, timeouts_[TRANSFERS_BULK]);
+            done += count;
+            if (instrumented) {
+                recordTransfer(false, endpointAddr, count, result != 0 || (transferred != nullptr && done != length), result == LIBUSB_ERROR_TIMEOUT, start);  // Each attempt is accounted for separately
+            }
+            retry = isRetryable(result) && attempt < retries_[TRANSFERS_BULK];
+            if (retry) {
+                if (result == LIBUSB_ERROR_PIPE) {
+                    transport_->clearHalt(endpointAddr);  // A stalled endpoint must be cleared before it can be used again, and if this fails, so does the retry
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(backoffs_[TRANSFERS_BULK]) << attempt));
+                ++attempt;
+            }
+        } while (retry);
+        if (transferred != nullptr) {
+            *transferred = done;
+        }
+        bool failed = result != 0 || (transferred != nullptr && done != length);
+        if (failed) {  // The number of transferred bytes is also verified, as long as a valid (non-null) pointer is passed via "transferred"
+            status.code = STATUS_BULK_FAILED;
+            status.result = result;
+            status.endpointAddr = endpointAddr;
+            if (result == LIBUSB_ERROR_NO_DEVICE || result == LIBUSB_ERROR_IO) {  // Note that libusb_bulk_transfer() may return "LIBUSB_ERROR_IO" [-1] on device disconnect, and that this is only checked after the last attempt
+                disconnected_ = true;  // This reports that the device has been disconnected
+            }
+        }
+    }
+    return status;
 }
 
 // Safe bulk transfer
+// Since version 1.3.0, this function is implemented on top of the previous one
 void CP2130::bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred, int &errcnt, std::string &errstr)
+{
+    Status status = bulkTransfer(endpointAddr, data, length, transferred);
+    if (status.code != STATUS_OK) {
+        ++errcnt;
+        errstr += status.message();
+    }
+}
+
+// Safe asynchronous bulk transfer (added in version 1.3.0)
+// The given callback is invoked from the event handling thread once the transfer completes, and the buffer pointed by "data" must remain valid until then
+// Several transfers can be submitted without waiting for the previous ones to complete, and transfers to the same endpoint complete in the order they were submitted
+// If the device was opened through a transport other than libusb, the transfer is carried out synchronously, and the callback is invoked before this function returns
+void CP2130::bulkTransferAsync(uint8_t endpointAddr, unsigned char *data, int length, const TransferCallback &callback, int &errcnt, std::string &errstr)
 {
     if (!isOpen()) {
         ++errcnt;
-        errstr += "In bulkTransfer(): device is not open.\n";  // Program logic error
+        errstr += "In bulkTransferAsync(): device is not open.\n";  // Program logic error
+    } else if (handle_ == nullptr) {  // Transport other than libusb (implemented in version 1.3.0)
+        bool instrumented = statsEnabled_.load(std::memory_order_relaxed);
+        std::chrono::steady_clock::time_point start;
+        if (instrumented) {
+            start = std::chrono::steady_clock::now();
+        }
+        int transferred = 0;
+        int result = transport_->bulkTransfer(endpointAddr, data, length, &transferred, timeouts_[TRANSFERS_BULK]);
+        if (instrumented) {
+            recordTransfer(false, endpointAddr, transferred, result != 0, result == LIBUSB_ERROR_TIMEOUT, start);
+        }
+        if (result == LIBUSB_ERROR_NO_DEVICE) {
+            disconnected_ = true;  // This reports that the device has been disconnected
+        }
+        if (callback) {
+            callback(transferStatus(result), transferred);
+        }
     } else {
-        int result = libusb_bulk_transfer(handle_, endpointAddr, data, length, transferred, TR_TIMEOUT);
-        if (result != 0 || (transferred != nullptr && *transferred != length)) {  // The number of transferred bytes is also verified, as long as a valid (non-null) pointer is passed via "transferred"
+        startEventHandling();
+        libusb_transfer *transfer = libusb_alloc_transfer(0);
+        std::lock_guard<std::mutex> lock(asyncMutex_);  // The lock is acquired before submitting, so that the transfer is registered before its callback gets to run
+        int result = LIBUSB_ERROR_NO_MEM;
+        if (transfer != nullptr) {
+            AsyncTransfer *record = new AsyncTransfer{this, callback, std::vector<unsigned char>(), nullptr, false, endpointAddr, std::chrono::steady_clock::time_point(), {false}};
+            if (statsEnabled_.load(std::memory_order_relaxed)) {
+                record->submitted = std::chrono::steady_clock::now();
+            }
+            libusb_fill_bulk_transfer(transfer, handle_, endpointAddr, data, length, asyncCallback, record, timeouts_[TRANSFERS_BULK]);
+            result = libusb_submit_transfer(transfer);
+            if (result != 0) {
+                delete record;
+                libusb_free_transfer(transfer);
+            }
+        }
+        if (result != 0) {
             ++errcnt;
             std::ostringstream stream;
-            if (endpointAddr < 0x80) {
-                stream << "Failed bulk OUT transfer to endpoint "
-                       << (0x0f & endpointAddr)
-                       << " (address 0x"
-                       << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(endpointAddr)
-                       << ")." << std::endl;
-            } else {
-                stream << "Failed bulk IN transfer from endpoint "
-                       << (0x0f & endpointAddr)
-                       << " (address 0x"
-                       << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(endpointAddr)
-                       << ")." << std::endl;
-            }
+            stream << "Failed to submit bulk "
+                   << (endpointAddr < 0x80 ? "OUT transfer to" : "IN transfer from")
+                   << " endpoint "
+                   << (0x0f & endpointAddr)
+                   << " (address 0x"
+                   << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(endpointAddr)
+                   << ")." << std::endl;
             errstr += stream.str();
-            if (result == LIBUSB_ERROR_NO_DEVICE || result == LIBUSB_ERROR_IO) {  // Note that libusb_bulk_transfer() may return "LIBUSB_ERROR_IO" [-1] on device disconnect
+            if (result == LIBUSB_ERROR_NO_DEVICE) {
                 disconnected_ = true;  // This reports that the device has been disconnected
             }
+        } else {
+            pendingTransfers_.insert(transfer);
         }
     }
 }
 
+#ifdef CP2130_COROUTINES
+// Safe asynchronous bulk transfer, returning an awaitable that yields the result instead of invoking a callback (added in version 1.3.0)
+// As in the previous function, the buffer pointed by "data" must remain valid until the transfer completes, which is always the case if it lives in the awaiting coroutine
+// Devices that are opened using a shared libusb context are served by the thread that handles its events, so that any number of transfers can be awaited across many devices without further threads
+CP2130::TransferAwaitable CP2130::bulkTransferAsync(uint8_t endpointAddr, unsigned char *data, int length, int &errcnt, std::string &errstr)
+{
+    TransferAwaitable awaitable;
+    int preverrcnt = errcnt;
+    bulkTransferAsync(endpointAddr, data, length, awaitable.callback(), errcnt, errstr);
+    if (errcnt != preverrcnt) {  // If the transfer could not be submitted, the awaitable is completed right away
+        awaitable.callback()(LIBUSB_TRANSFER_ERROR, 0);
+    }
+    return awaitable;
+}
+#endif
+
+// Writes asynchronously the given data to the given bulk OUT endpoint, returning a future that holds the result (added in version 1.3.0)
+std::future<CP2130::TransferResult> CP2130::bulkWriteAsync(uint8_t endpointOutAddr, const std::vector<uint8_t> &data, int &errcnt, std::string &errstr)
+{
+    std::shared_ptr<std::vector<uint8_t>> buffer = std::make_shared<std::vector<uint8_t>>(data);  // The data is copied, so that it remains valid until the transfer completes
+    std::shared_ptr<std::promise<TransferResult>> promise = std::make_shared<std::promise<TransferResult>>();
+    std::future<TransferResult> future = promise->get_future();
+    int preverrcnt = errcnt;
+    bulkTransferAsync(endpointOutAddr, buffer->data(), static_cast<int>(buffer->size()), [buffer, promise](int status, int transferred) {
+        promise->set_value(TransferResult{status, transferred, std::vector<uint8_t>()});
+    }, errcnt, errstr);
+    if (errcnt != preverrcnt) {  // If the transfer could not be submitted, the future is fulfilled right away
+        promise->set_value(TransferResult{LIBUSB_TRANSFER_ERROR, 0, std::vector<uint8_t>()});
+    }
+    return future;
+}
+
 // Closes the device safely, if open
+// Since version 1.3.0, the device is left open if this is called from a transfer callback (see stopEventHandling())
 void CP2130::close()
 {
-    if (isOpen()) {  // This condition avoids a segmentation fault if the calling algorithm tries, for some reason, to close the same device twice (e.g., if the device is already closed when the destructor is called)
-        libusb_release_interface(handle_, 0);  // Release the interface
-        if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
-            libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
+    if (isOpen() && stopEventHandling()) {  // This condition avoids a segmentation fault if the calling algorithm tries, for some reason, to close the same device twice (e.g., if the device is already closed when the destructor is called), and any pending asynchronous transfers are cancelled first (implemented in version 1.3.0)
+        if (handle_ != nullptr) {  // A device opened through a transport other than libusb has no handle, and the transport is left for its owner to dispose of (implemented in version 1.3.0)
+            libusb_release_interface(handle_, 0);  // Release the interface
+            if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
+                libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
+            }
+            libusb_close(handle_);  // Close the device
+            if (ownsContext_) {  // A shared context is left for its owner to deinitialize (implemented in version 1.3.0)
+                libusb_exit(context_);  // Deinitialize libusb
+            }
+            handle_ = nullptr;
+            libusbTransport_.setHandle(nullptr);
         }
-        libusb_close(handle_);  // Close the device
-        libusb_exit(context_);  // Deinitialize libusb
-        handle_ = nullptr;  // Required to mark the device as closed
+        transport_ = nullptr;  // Required to mark the device as closed
+        endpointsCached_ = false;
+        csKnown_ = 0x0000;  // Another device may be opened next (implemented in version 1.3.0)
+        prom_.clear();
     }
 }
 
@@ -317,42 +1202,248 @@ void CP2130::configureSPIMode(uint8_t channel, const SPIMode &mode, int &errcnt,
     }
 }
 
+// Safe asynchronous device-to-host control transfer, which reads the data stage of the given vendor request into "data" (added in version 1.3.0)
+// The given buffer must remain valid until the given callback is invoked, which happens once the transfer completes, from the event handling thread, and after the data is copied
+// As in controlTransferAsync(), control transfers complete in the order they were submitted, and the transfer is carried out synchronously if the device was opened through a transport other than libusb
+void CP2130::controlReadAsync(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, const TransferCallback &callback, int &errcnt, std::string &errstr)
+{
+    if (!isOpen()) {
+        ++errcnt;
+        errstr += "In controlReadAsync(): device is not open.\n";  // Program logic error
+    } else if (handle_ == nullptr) {  // Transport other than libusb
+        bool instrumented = statsEnabled_.load(std::memory_order_relaxed);
+        std::chrono::steady_clock::time_point start;
+        if (instrumented) {
+            start = std::chrono::steady_clock::now();
+        }
+        int result = transport_->controlTransfer(GET, bRequest, wValue, wIndex, data, wLength, timeouts_[transferClass(bRequest)]);
+        if (instrumented) {
+            recordTransfer(true, bRequest, result, result != wLength, result == LIBUSB_ERROR_TIMEOUT, start);
+        }
+        if (result == LIBUSB_ERROR_NO_DEVICE) {
+            disconnected_ = true;  // This reports that the device has been disconnected
+        }
+        if (callback) {
+            int status = result < 0 ? transferStatus(result) : (result == wLength ? LIBUSB_TRANSFER_COMPLETED : LIBUSB_TRANSFER_ERROR);  // As in controlTransferAsync(), a short data stage is reported as an error
+            callback(status, result < 0 ? 0 : result);
+        }
+    } else {
+        startEventHandling();
+        libusb_transfer *transfer = libusb_alloc_transfer(0);
+        std::lock_guard<std::mutex> lock(asyncMutex_);  // As in bulkTransferAsync(), the lock is acquired before submitting
+        int result = LIBUSB_ERROR_NO_MEM;
+        if (transfer != nullptr) {
+            AsyncTransfer *record = new AsyncTransfer{this, callback, std::vector<unsigned char>(LIBUSB_CONTROL_SETUP_SIZE + wLength), data, true, bRequest, std::chrono::steady_clock::time_point(), {false}};  // The data stage is copied to "data" on completion (see asyncCallback())
+            if (statsEnabled_.load(std::memory_order_relaxed)) {
+                record->submitted = std::chrono::steady_clock::now();
+            }
+            libusb_fill_control_setup(record->buffer.data(), GET, bRequest, wValue, wIndex, wLength);
+            libusb_fill_control_transfer(transfer, handle_, record->buffer.data(), asyncCallback, record, timeouts_[transferClass(bRequest)]);
+            result = libusb_submit_transfer(transfer);
+            if (result != 0) {
+                delete record;
+                libusb_free_transfer(transfer);
+            }
+        }
+        if (result != 0) {
+            ++errcnt;
+            std::ostringstream stream;
+            stream << "Failed to submit control transfer (0x"
+                   << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(GET)
+                   << ", 0x"
+                   << std::setw(2) << static_cast<int>(bRequest)
+                   << ")." << std::endl;
+            errstr += stream.str();
+            if (result == LIBUSB_ERROR_NO_DEVICE) {
+                disconnected_ = true;  // This reports that the device has been disconnected
+            }
+        } else {
+            pendingTransfers_.insert(transfer);
+        }
+    }
+}
+
+#ifdef CP2130_COROUTINES
+// Safe asynchronous device-to-host control transfer, returning an awaitable that yields the result instead of invoking a callback (see bulkTransferAsync() - added in version 1.3.0)
+CP2130::TransferAwaitable CP2130::controlReadAsync(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr)
+{
+    TransferAwaitable awaitable;
+    int preverrcnt = errcnt;
+    controlReadAsync(bRequest, wValue, wIndex, data, wLength, awaitable.callback(), errcnt, errstr);
+    if (errcnt != preverrcnt) {
+        awaitable.callback()(LIBUSB_TRANSFER_ERROR, 0);
+    }
+    return awaitable;
+}
+#endif
+
+// Safe control transfer, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+// This function neither allocates memory nor touches strings, so it is suitable for hot loops (see Status::message() for getting the corresponding error message)
+// Since version 1.3.0, failed attempts are retried as per the policy of the transfer class of the given request (see setTransferPolicy())
+CP2130::Status CP2130::controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength)
+{
+    Status status = {STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (!isOpen()) {
+        status.code = STATUS_NOT_OPEN;  // Program logic error
+        status.function = "controlTransfer";
+    } else {
+        bool instrumented = statsEnabled_.load(std::memory_order_relaxed);  // See the previous function
+        uint8_t trclass = transferClass(bRequest);
+        int result;
+        bool retry;
+        uint8_t attempt = 0;
+        do {  // Unlike bulk transfers, a control transfer is retried as a whole, and a stalled control endpoint clears on its own (implemented in version 1.3.0)
+            std::chrono::steady_clock::time_point start;
+            if (instrumented) {
+                start = std::chrono::steady_clock::now();
+            }
+            result = transport_->controlTransfer(bmRequestType, bRequest, wValue, wIndex, data, wLength, timeouts_[trclass]);
+            if (instrumented) {
+                recordTransfer(true, bRequest, result, result != wLength, result == LIBUSB_ERROR_TIMEOUT, start);
+            }
+            retry = isRetryable(result) && attempt < retries_[trclass];
+            if (retry) {
+                std::this_thread::sleep_for(std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(backoffs_[trclass]) << attempt));
+                ++attempt;
+            }
+        } while (retry);
+        trackRequest(bmRequestType, bRequest, data, wLength, result == wLength);
+        if (result != wLength) {
+            status.code = STATUS_CONTROL_FAILED;
+            status.result = result;
+            status.bmRequestType = bmRequestType;
+            status.bRequest = bRequest;
+            if (result == LIBUSB_ERROR_NO_DEVICE || result == LIBUSB_ERROR_IO || result == LIBUSB_ERROR_PIPE) {  // Note that libusb_control_transfer() may return "LIBUSB_ERROR_IO" [-1] or "LIBUSB_ERROR_PIPE" [-9] on device disconnect, and that this is only checked after the last attempt
+                disconnected_ = true;  // This reports that the device has been disconnected
+            }
+        }
+    }
+    return status;
+}
+
 // Safe control transfer
+// Since version 1.3.0, this function is implemented on top of the previous one
 void CP2130::controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr)
+{
+    Status status = controlTransfer(bmRequestType, bRequest, wValue, wIndex, data, wLength);
+    if (status.code != STATUS_OK) {
+        ++errcnt;
+        errstr += status.message();
+    }
+}
+
+// Safe asynchronous control transfer (added in version 1.3.0)
+// Only host-to-device requests are supported, and the given data is copied, so that it does not need to remain valid after this function returns
+// The given callback is invoked from the event handling thread once the transfer completes, and control transfers complete in the order they were submitted
+// As in bulkTransferAsync(), the transfer is carried out synchronously if the device was opened through a transport other than libusb
+void CP2130::controlTransferAsync(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const unsigned char *data, uint16_t wLength, const TransferCallback &callback, int &errcnt, std::string &errstr)
 {
     if (!isOpen()) {
         ++errcnt;
-        errstr += "In controlTransfer(): device is not open.\n";  // Program logic error
+        errstr += "In controlTransferAsync(): device is not open.\n";  // Program logic error
+    } else if ((0x80 & bmRequestType) != 0) {
+        ++errcnt;
+        errstr += "In controlTransferAsync(): Only host-to-device requests are supported.\n";  // Program logic error
+    } else if (handle_ == nullptr) {  // Transport other than libusb (implemented in version 1.3.0)
+        std::vector<unsigned char> buffer(data, data + (data == nullptr ? 0 : wLength));  // The transport takes a non-const buffer
+        bool instrumented = statsEnabled_.load(std::memory_order_relaxed);
+        std::chrono::steady_clock::time_point start;
+        if (instrumented) {
+            start = std::chrono::steady_clock::now();
+        }
+        int result = transport_->controlTransfer(bmRequestType, bRequest, wValue, wIndex, buffer.data(), wLength, timeouts_[transferClass(bRequest)]);
+        if (instrumented) {
+            recordTransfer(true, bRequest, result, result != wLength, result == LIBUSB_ERROR_TIMEOUT, start);
+        }
+        trackRequest(bmRequestType, bRequest, buffer.data(), wLength, result == wLength);
+        if (result == LIBUSB_ERROR_NO_DEVICE) {
+            disconnected_ = true;  // This reports that the device has been disconnected
+        }
+        if (callback) {
+            int status = result < 0 ? transferStatus(result) : (result == wLength ? LIBUSB_TRANSFER_COMPLETED : LIBUSB_TRANSFER_ERROR);  // A short data stage is reported as an error
+            callback(status, result < 0 ? 0 : result);
+        }
     } else {
-        int result = libusb_control_transfer(handle_, bmRequestType, bRequest, wValue, wIndex, data, wLength, TR_TIMEOUT);
-        if (result != wLength) {
+        trackRequest(bmRequestType, bRequest, data, wLength, false);  // The outcome is not known at this point, so any affected chip selects are considered unknown
+        startEventHandling();
+        libusb_transfer *transfer = libusb_alloc_transfer(0);
+        std::lock_guard<std::mutex> lock(asyncMutex_);  // As in bulkTransferAsync(), the lock is acquired before submitting
+        int result = LIBUSB_ERROR_NO_MEM;
+        if (transfer != nullptr) {
+            AsyncTransfer *record = new AsyncTransfer{this, callback, std::vector<unsigned char>(LIBUSB_CONTROL_SETUP_SIZE + wLength), nullptr, true, bRequest, std::chrono::steady_clock::time_point(), {false}};  // The buffer holds the setup packet, followed by the data stage
+            if (statsEnabled_.load(std::memory_order_relaxed)) {
+                record->submitted = std::chrono::steady_clock::now();
+            }
+            unsigned char *buffer = record->buffer.data();
+            libusb_fill_control_setup(buffer, bmRequestType, bRequest, wValue, wIndex, wLength);
+            if (wLength != 0) {
+                std::copy(data, data + wLength, buffer + LIBUSB_CONTROL_SETUP_SIZE);
+            }
+            libusb_fill_control_transfer(transfer, handle_, buffer, asyncCallback, record, timeouts_[transferClass(bRequest)]);
+            result = libusb_submit_transfer(transfer);
+            if (result != 0) {
+                delete record;
+                libusb_free_transfer(transfer);
+            }
+        }
+        if (result != 0) {
             ++errcnt;
             std::ostringstream stream;
-            stream << "Failed control transfer (0x"
+            stream << "Failed to submit control transfer (0x"
                    << std::hex << std::setfill ('0') << std::setw(2) << static_cast<int>(bmRequestType)
                    << ", 0x"
                    << std::setw(2) << static_cast<int>(bRequest)
                    << ")." << std::endl;
             errstr += stream.str();
-            if (result == LIBUSB_ERROR_NO_DEVICE || result == LIBUSB_ERROR_IO || result == LIBUSB_ERROR_PIPE) {  // Note that libusb_control_transfer() may return "LIBUSB_ERROR_IO" [-1] or "LIBUSB_ERROR_PIPE" [-9] on device disconnect
+            if (result == LIBUSB_ERROR_NO_DEVICE) {
                 disconnected_ = true;  // This reports that the device has been disconnected
             }
+        } else {
+            pendingTransfers_.insert(transfer);
         }
     }
 }
 
-// Disables the chip select of the target channel
-void CP2130::disableCS(uint8_t channel, int &errcnt, std::string &errstr)
+#ifdef CP2130_COROUTINES
+// Safe asynchronous control transfer, returning an awaitable that yields the result instead of invoking a callback (see bulkTransferAsync() - added in version 1.3.0)
+CP2130::TransferAwaitable CP2130::controlTransferAsync(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr)
+{
+    TransferAwaitable awaitable;
+    int preverrcnt = errcnt;
+    controlTransferAsync(bmRequestType, bRequest, wValue, wIndex, data, wLength, awaitable.callback(), errcnt, errstr);
+    if (errcnt != preverrcnt) {
+        awaitable.callback()(LIBUSB_TRANSFER_ERROR, 0);
+    }
+    return awaitable;
+}
+#endif
+
+// Disables the chip select of the target channel, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+CP2130::Status CP2130::disableCS(uint8_t channel)
 {
+    Status status = {STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
     if (channel > 10) {
-        ++errcnt;
-        errstr += "In disableCS(): SPI channel value must be between 0 and 10.\n";  // Program logic error
-    } else {
+        status.code = STATUS_INVALID_ARGUMENT;  // Program logic error
+        status.function = "disableCS";
+        status.detail = "SPI channel value must be between 0 and 10.";
+    } else if ((0x0001 << channel & csKnown_ & ~csState_) == 0x0000) {  // Since version 1.3.0, the request is skipped if the chip select is known to be disabled already (see invalidateCS())
         unsigned char controlBufferOut[SET_GPIO_CHIP_SELECT_WLEN] = {
             channel,  // Selected channel
             0x00      // Corresponding chip select disabled
         };
-        controlTransfer(SET, SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut, SET_GPIO_CHIP_SELECT_WLEN, errcnt, errstr);
+        status = controlTransfer(SET, SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut, SET_GPIO_CHIP_SELECT_WLEN);
+    }
+    return status;
+}
+
+// Disables the chip select of the target channel
+// Since version 1.3.0, this function is implemented on top of the previous one
+void CP2130::disableCS(uint8_t channel, int &errcnt, std::string &errstr)
+{
+    Status status = disableCS(channel);
+    if (status.code != STATUS_OK) {
+        ++errcnt;
+        errstr += status.message();
     }
 }
 
@@ -370,22 +1461,135 @@ void CP2130::disableSPIDelays(uint8_t channel, int &errcnt, std::string &errstr)
             0x00, 0x00,  // post-assert and
             0x00, 0x00   // pre-deassert delays all set to 0us
         };
-        controlTransfer(SET, SET_SPI_DELAY, 0x0000, 0x0000, controlBufferOut, SET_SPI_DELAY_WLEN, errcnt, errstr);
+        controlTransfer(SET, SET_SPI_DELAY, 0x0000, 0x0000, controlBufferOut, SET_SPI_DELAY_WLEN, errcnt, errstr);
+    }
+}
+
+// Disables statistics, keeping the ones gathered so far (added in version 1.3.0)
+void CP2130::disableStats()
+{
+    statsEnabled_ = false;
+}
+
+// Enables the chip select of the target channel, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+CP2130::Status CP2130::enableCS(uint8_t channel)
+{
+    Status status = {STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (channel > 10) {
+        status.code = STATUS_INVALID_ARGUMENT;  // Program logic error
+        status.function = "enableCS";
+        status.detail = "SPI channel value must be between 0 and 10.";
+    } else if ((0x0001 << channel & csKnown_ & csState_) == 0x0000) {  // Since version 1.3.0, the request is skipped if the chip select is known to be enabled already (see invalidateCS())
+        unsigned char controlBufferOut[SET_GPIO_CHIP_SELECT_WLEN] = {
+            channel,  // Selected channel
+            0x01      // Corresponding chip select enabled
+        };
+        status = controlTransfer(SET, SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut, SET_GPIO_CHIP_SELECT_WLEN);
     }
+    return status;
 }
 
 // Enables the chip select of the target channel
+// Since version 1.3.0, this function is implemented on top of the previous one
 void CP2130::enableCS(uint8_t channel, int &errcnt, std::string &errstr)
 {
-    if (channel > 10) {
+    Status status = enableCS(channel);
+    if (status.code != STATUS_OK) {
         ++errcnt;
-        errstr += "In enableCS(): SPI channel value must be between 0 and 10.\n";  // Program logic error
-    } else {
-        unsigned char controlBufferOut[SET_GPIO_CHIP_SELECT_WLEN] = {
-            channel,  // Selected channel
-            0x01      // Corresponding chip select enabled
-        };
-        controlTransfer(SET, SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut, SET_GPIO_CHIP_SELECT_WLEN, errcnt, errstr);
+        errstr += status.message();
+    }
+}
+
+// Enables statistics regarding synchronous and asynchronous transfers, which can be retrieved using getStats() (added in version 1.3.0)
+// While disabled, statistics have a negligible cost, since neither the clock is read nor any locks are taken
+void CP2130::enableStats()
+{
+    statsEnabled_ = true;
+}
+
+// Executes the given batch, submitting its operations back to back through the asynchronous path (added in version 1.3.0)
+// Consecutive operations on the same pipe are queued without waiting, while a switch between pipes (e.g. from a control transfer to a bulk transfer) waits for the previous operations to complete, so that the order is preserved
+// Errors are aggregated, so that a single message is appended to "errstr", while "errcnt" is incremented once per failed operation
+// Once an operation fails, no further operations are submitted
+void CP2130::executeBatch(const Batch &batch, int &errcnt, std::string &errstr)
+{
+    std::vector<std::chrono::microseconds> timestamps;
+    executeBatch(batch, timestamps, errcnt, errstr);
+}
+
+// Same as the previous function, but also returns, via "timestamps", the completion time of each operation, relative to the start of the execution (added in version 1.3.0)
+// Operations that were not executed have a negative timestamp
+void CP2130::executeBatch(const Batch &batch, std::vector<std::chrono::microseconds> &timestamps, int &errcnt, std::string &errstr)
+{
+    size_t nops = batch.operations_.size();
+    timestamps.assign(nops, std::chrono::microseconds(-1));
+    if (!isOpen()) {
+        ++errcnt;
+        errstr += "In executeBatch(): device is not open.\n";  // Program logic error
+    } else if (nops != 0) {
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t pending = 0, failed = 0, firstFailure = nops, executed = 0;
+        std::vector<std::vector<unsigned char>> buffers(nops);  // Bulk data is copied here, so that it remains valid until each transfer completes
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int pipe = -1;  // Pipe of the previous operation (0x00 for the control pipe, or the endpoint address for bulk transfers)
+        for (size_t i = 0; i < nops; ++i) {
+            const Batch::Operation &operation = batch.operations_[i];
+            int operationPipe = operation.kind == OP_DELAY ? -1 : (operation.kind == OP_CONTROL ? 0x00 : operation.endpointAddr);
+            std::unique_lock<std::mutex> lock(mutex);
+            if (operationPipe != pipe) {
+                condition.wait(lock, [&pending] { return pending == 0; });
+                pipe = operationPipe;
+            }
+            if (failed != 0) {
+                break;
+            }
+            ++executed;
+            if (operation.kind == OP_DELAY) {
+                lock.unlock();
+                std::this_thread::sleep_for(std::chrono::microseconds(operation.delay));
+                timestamps[i] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            } else {
+                ++pending;
+                lock.unlock();
+                int expected = static_cast<int>(operation.data.size());
+                TransferCallback callback = [&, i, expected](int status, int transferred) {
+                    std::lock_guard<std::mutex> callbackLock(mutex);
+                    timestamps[i] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                    if (status != LIBUSB_TRANSFER_COMPLETED || transferred != expected) {
+                        ++failed;
+                        firstFailure = std::min(firstFailure, i);
+                    }
+                    --pending;
+                    condition.notify_one();
+                };
+                int submiterrcnt = 0;  // Submission errors are aggregated with any other failures, below
+                std::string submiterrstr;
+                if (operation.kind == OP_CONTROL) {
+                    controlTransferAsync(operation.bmRequestType, operation.bRequest, operation.wValue, operation.wIndex, operation.data.data(), static_cast<uint16_t>(expected), callback, submiterrcnt, submiterrstr);
+                } else {
+                    buffers[i].assign(operation.data.begin(), operation.data.end());
+                    bulkTransferAsync(operation.endpointAddr, buffers[i].data(), expected, callback, submiterrcnt, submiterrstr);
+                }
+                if (submiterrcnt != 0) {
+                    lock.lock();
+                    --pending;
+                    ++failed;
+                    firstFailure = std::min(firstFailure, i);
+                    break;
+                }
+            }
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&pending] { return pending == 0; });  // Wait for all submitted operations to complete
+        if (failed != 0) {
+            errcnt += static_cast<int>(failed);
+            std::ostringstream stream;
+            stream << "Failed to execute batch ("
+                   << failed << " of " << nops << " operations failed, starting at operation " << firstFailure
+                   << ", and " << nops - executed << " were not executed)." << std::endl;
+            errstr += stream.str();
+        }
     }
 }
 
@@ -413,16 +1617,64 @@ bool CP2130::getCS(uint8_t channel, int &errcnt, std::string &errstr)
     return cs;
 }
 
+// Assigns the address of the endpoint assuming the IN direction to "endpointInAddr", returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+// As long as the address is cached, which is the case once the device is opened, no transfers are required and no strings are touched
+CP2130::Status CP2130::getEndpointInAddr(uint8_t &endpointInAddr)
+{
+    Status status = {STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (!endpointsCached_) {
+        int errcnt = 0;
+        std::string errstr;
+        cacheEndpoints(errcnt, errstr);  // Cold path, only taken after the cache is invalidated (e.g. by writeUSBConfig())
+        if (errcnt != 0) {
+            status.code = isOpen() ? STATUS_CONTROL_FAILED : STATUS_NOT_OPEN;
+            status.function = "getEndpointInAddr";
+            status.bmRequestType = GET;
+            status.bRequest = GET_USB_CONFIG;
+        }
+    }
+    endpointInAddr = endpointsCached_ ? endpointInAddr_ : 0x81;
+    return status;
+}
+
 // Returns the address of the endpoint assuming the IN direction
+// Since version 1.3.0, the address is cached when the device is opened, so that no transfers are required
 uint8_t CP2130::getEndpointInAddr(int &errcnt, std::string &errstr)
 {
-    return getTransferPriority(errcnt, errstr) == PRIOWRITE ? 0x82 : 0x81;
+    if (!endpointsCached_) {
+        cacheEndpoints(errcnt, errstr);
+    }
+    return endpointsCached_ ? endpointInAddr_ : 0x81;
+}
+
+// Assigns the address of the endpoint assuming the OUT direction to "endpointOutAddr", returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+// See the previous function for details
+CP2130::Status CP2130::getEndpointOutAddr(uint8_t &endpointOutAddr)
+{
+    Status status = {STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (!endpointsCached_) {
+        int errcnt = 0;
+        std::string errstr;
+        cacheEndpoints(errcnt, errstr);  // Cold path, only taken after the cache is invalidated (e.g. by writeUSBConfig())
+        if (errcnt != 0) {
+            status.code = isOpen() ? STATUS_CONTROL_FAILED : STATUS_NOT_OPEN;
+            status.function = "getEndpointOutAddr";
+            status.bmRequestType = GET;
+            status.bRequest = GET_USB_CONFIG;
+        }
+    }
+    endpointOutAddr = endpointsCached_ ? endpointOutAddr_ : 0x02;
+    return status;
 }
 
 // Returns the address of the endpoint assuming the OUT direction
+// Since version 1.3.0, the address is cached when the device is opened, so that no transfers are required
 uint8_t CP2130::getEndpointOutAddr(int &errcnt, std::string &errstr)
 {
-    return getTransferPriority(errcnt, errstr) == PRIOWRITE ? 0x01 : 0x02;
+    if (!endpointsCached_) {
+        cacheEndpoints(errcnt, errstr);
+    }
+    return endpointsCached_ ? endpointOutAddr_ : 0x02;
 }
 
 // Gets the event counter, including mode and value
@@ -523,21 +1775,31 @@ uint16_t CP2130::getGPIOs(int &errcnt, std::string &errstr)
 uint16_t CP2130::getLockWord(int &errcnt, std::string &errstr)
 {
     unsigned char controlBufferIn[GET_LOCK_BYTE_WLEN];
-    controlTransfer(GET, GET_LOCK_BYTE, 0x0000, 0x0000, controlBufferIn, GET_LOCK_BYTE_WLEN, errcnt, errstr);
+    getPROMField(GET_LOCK_BYTE, controlBufferIn, GET_LOCK_BYTE_WLEN, errcnt, errstr);  // Since version 1.3.0, the field is taken from the cached OTP ROM, if available
     return static_cast<uint16_t>(controlBufferIn[1] << 8 | controlBufferIn[0]);  // Returns both lock bytes as a word (little-endian conversion)
 }
 
 // Gets the manufacturer descriptor from the CP2130 OTP ROM
 std::u16string CP2130::getManufacturerDesc(int &errcnt, std::string &errstr)
 {
-    return getDescGeneric(GET_MANUFACTURING_STRING_1, errcnt, errstr);
+    std::u16string manufacturer;
+    manufacturer.reserve(DESCMXL_MANUFACTURER);  // Since version 1.3.0, the descriptor is built in place, without reallocations
+    getDescGeneric(GET_MANUFACTURING_STRING_1, manufacturer, errcnt, errstr);
+    return manufacturer;
+}
+
+// Gets the manufacturer descriptor from the CP2130 OTP ROM into the given string, reusing its storage (added in version 1.3.0)
+// This is meant for inventory scans across many devices, where the same string can be passed for every device
+void CP2130::getManufacturerDesc(std::u16string &manufacturer, int &errcnt, std::string &errstr)
+{
+    getDescGeneric(GET_MANUFACTURING_STRING_1, manufacturer, errcnt, errstr);
 }
 
 // Gets the pin configuration from the CP2130 OTP ROM
 CP2130::PinConfig CP2130::getPinConfig(int &errcnt, std::string &errstr)
 {
     unsigned char controlBufferIn[GET_PIN_CONFIG_WLEN];
-    controlTransfer(GET, GET_PIN_CONFIG, 0x0000, 0x0000, controlBufferIn, GET_PIN_CONFIG_WLEN, errcnt, errstr);
+    getPROMField(GET_PIN_CONFIG, controlBufferIn, GET_PIN_CONFIG_WLEN, errcnt, errstr);  // Since version 1.3.0, the field is taken from the cached OTP ROM, if available
     PinConfig config;
     config.gpio0 = controlBufferIn[0];                                                         // GPIO.0 pin config corresponds to byte 0
     config.gpio1 = controlBufferIn[1];                                                         // GPIO.1 pin config corresponds to byte 1
@@ -561,19 +1823,38 @@ CP2130::PinConfig CP2130::getPinConfig(int &errcnt, std::string &errstr)
 // Gets the product descriptor from the CP2130 OTP ROM
 std::u16string CP2130::getProductDesc(int &errcnt, std::string &errstr)
 {
-    return getDescGeneric(GET_PRODUCT_STRING_1, errcnt, errstr);
+    std::u16string product;
+    product.reserve(DESCMXL_PRODUCT);
+    getDescGeneric(GET_PRODUCT_STRING_1, product, errcnt, errstr);
+    return product;
+}
+
+// Gets the product descriptor from the CP2130 OTP ROM into the given string, reusing its storage (see getManufacturerDesc(std::u16string &, int &, std::string &) - added in version 1.3.0)
+void CP2130::getProductDesc(std::u16string &product, int &errcnt, std::string &errstr)
+{
+    getDescGeneric(GET_PRODUCT_STRING_1, product, errcnt, errstr);
 }
 
 // Gets the entire CP2130 OTP ROM content as a structure of eight 64-byte blocks
+// Since version 1.3.0, the content is cached once read, and any subsequent calls to this function, as well as to the getters of the OTP ROM fields, are answered from the cached copy
+// Also since version 1.3.0, the remaining blocks are not read after a failure, since the content would not be cached anyway
 CP2130::PROMConfig CP2130::getPROMConfig(int &errcnt, std::string &errstr)
 {
-    PROMConfig config;
-    for (size_t i = 0; i < PROM_BLOCKS; ++i) {
-        unsigned char controlBufferIn[GET_PROM_CONFIG_WLEN];
-        controlTransfer(GET, GET_PROM_CONFIG, 0x0000, static_cast<uint16_t>(i), controlBufferIn, GET_PROM_CONFIG_WLEN, errcnt, errstr);
-        for (size_t j = 0; j < PROM_BLOCK_SIZE; ++j) {
-            config.blocks[i][j] = controlBufferIn[j];
+    PROMConfig config = {};
+    if (prom_.empty()) {
+        int preverrcnt = errcnt;
+        for (size_t i = 0; i < PROM_BLOCKS && errcnt == preverrcnt; ++i) {  // The loop is interrupted in case of error
+            unsigned char controlBufferIn[GET_PROM_CONFIG_WLEN];
+            controlTransfer(GET, GET_PROM_CONFIG, 0x0000, static_cast<uint16_t>(i), controlBufferIn, GET_PROM_CONFIG_WLEN, errcnt, errstr);
+            for (size_t j = 0; j < PROM_BLOCK_SIZE; ++j) {
+                config.blocks[i][j] = controlBufferIn[j];
+            }
+        }
+        if (errcnt == preverrcnt) {  // Since version 1.3.0, the OTP ROM is cached once successfully read
+            prom_.assign(&config.blocks[0][0], &config.blocks[0][0] + PROM_SIZE);
         }
+    } else {
+        std::copy(prom_.begin(), prom_.end(), &config.blocks[0][0]);
     }
     return config;
 }
@@ -581,7 +1862,16 @@ CP2130::PROMConfig CP2130::getPROMConfig(int &errcnt, std::string &errstr)
 // Gets the serial descriptor from the CP2130 OTP ROM
 std::u16string CP2130::getSerialDesc(int &errcnt, std::string &errstr)
 {
-    return getDescGeneric(GET_SERIAL_STRING, errcnt, errstr);
+    std::u16string serial;
+    serial.reserve(DESCMXL_SERIAL);
+    getDescGeneric(GET_SERIAL_STRING, serial, errcnt, errstr);
+    return serial;
+}
+
+// Gets the serial descriptor from the CP2130 OTP ROM into the given string, reusing its storage (see getManufacturerDesc(std::u16string &, int &, std::string &) - added in version 1.3.0)
+void CP2130::getSerialDesc(std::u16string &serial, int &errcnt, std::string &errstr)
+{
+    getDescGeneric(GET_SERIAL_STRING, serial, errcnt, errstr);
 }
 
 // Returns the CP2130 silicon, read-only version
@@ -636,6 +1926,46 @@ CP2130::SPIMode CP2130::getSPIMode(uint8_t channel, int &errcnt, std::string &er
     return mode;
 }
 
+// Returns a snapshot of the transfer statistics gathered so far (added in version 1.3.0)
+CP2130::Stats CP2130::getStats() const
+{
+    Stats stats;
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    for (size_t i = 0; i < 2; ++i) {
+        const std::vector<uint64_t> &table = i == 0 ? controlStats_ : bulkStats_;
+        std::map<uint8_t, Metrics> &metrics = i == 0 ? stats.control : stats.bulk;
+        for (size_t j = 0; j < table.size() / ST_STRIDE; ++j) {
+            const uint64_t *record = table.data() + ST_STRIDE * j;
+            if (record[ST_CALLS] != 0) {
+                Metrics &entry = metrics[static_cast<uint8_t>(j)];
+                entry.calls = record[ST_CALLS];
+                entry.bytes = record[ST_BYTES];
+                entry.errors = record[ST_ERRORS];
+                entry.timeouts = record[ST_TIMEOUTS];
+                entry.totalLatency = record[ST_TOTALLAT];
+                entry.maxLatency = record[ST_MAXLAT];
+                std::copy(record + ST_HISTOGRAM, record + ST_STRIDE, entry.histogram);
+            }
+        }
+    }
+    return stats;
+}
+
+// Gets the timeout and retry policy of the given transfer class (added in version 1.3.0)
+CP2130::TransferPolicy CP2130::getTransferPolicy(uint8_t transferClass, int &errcnt, std::string &errstr) const
+{
+    TransferPolicy policy = {TR_TIMEOUT, 0, 0};
+    if (transferClass > TRANSFERS_PROM) {
+        ++errcnt;
+        errstr += "In getTransferPolicy(): Transfer class must be TRANSFERS_CONTROL, TRANSFERS_BULK or TRANSFERS_PROM.\n";  // Program logic error
+    } else {
+        policy.timeout = timeouts_[transferClass];
+        policy.retries = retries_[transferClass];
+        policy.backoff = backoffs_[transferClass];
+    }
+    return policy;
+}
+
 // Returns the transfer priority from the CP2130 OTP ROM
 uint8_t CP2130::getTransferPriority(int &errcnt, std::string &errstr)
 {
@@ -643,10 +1973,16 @@ uint8_t CP2130::getTransferPriority(int &errcnt, std::string &errstr)
 }
 
 // Gets the USB configuration, including VID, PID, major and minor release versions, from the CP2130 OTP ROM
+// Since version 1.3.0, the configuration is taken from the cached OTP ROM, if available, and otherwise it is read on its own, without caching the OTP ROM
+// This keeps open() to a single control transfer, since the endpoint addresses are determined from the transfer priority (see cacheEndpoints())
 CP2130::USBConfig CP2130::getUSBConfig(int &errcnt, std::string &errstr)
 {
     unsigned char controlBufferIn[GET_USB_CONFIG_WLEN];
-    controlTransfer(GET, GET_USB_CONFIG, 0x0000, 0x0000, controlBufferIn, GET_USB_CONFIG_WLEN, errcnt, errstr);
+    if (prom_.empty()) {
+        controlTransfer(GET, GET_USB_CONFIG, 0x0000, 0x0000, controlBufferIn, GET_USB_CONFIG_WLEN, errcnt, errstr);
+    } else {
+        getPROMField(GET_USB_CONFIG, controlBufferIn, GET_USB_CONFIG_WLEN, errcnt, errstr);
+    }
     USBConfig config;
     config.vid = static_cast<uint16_t>(controlBufferIn[1] << 8 | controlBufferIn[0]);  // VID corresponds to bytes 0 and 1 (little-endian conversion)
     config.pid = static_cast<uint16_t>(controlBufferIn[3] << 8 | controlBufferIn[2]);  // PID corresponds to bytes 2 and 3 (little-endian conversion)
@@ -658,6 +1994,21 @@ CP2130::USBConfig CP2130::getUSBConfig(int &errcnt, std::string &errstr)
     return config;
 }
 
+// Discards the tracked chip select state, so that the next call to disableCS(), enableCS() or selectCS() is carried out regardless (added in version 1.3.0)
+// Since version 1.3.0, these functions skip any request that would not change the state of the chip selects, as set by them or read via getCS()
+// This is only required if the chip selects may have been changed by other means, such as another program or a batch that is still pending
+void CP2130::invalidateCS()
+{
+    csKnown_ = 0x0000;
+}
+
+// Discards the cached copy of the OTP ROM, so that it is read again on the next call to getPROMConfig() (added in version 1.3.0)
+// This is never required while the device is open, since any writes to the OTP ROM discard the cached copy as well
+void CP2130::invalidatePROM()
+{
+    prom_.clear();
+}
+
 // Returns true is the OTP ROM of the CP2130 was never written
 bool CP2130::isOTPBlank(int &errcnt, std::string &errstr)
 {
@@ -694,59 +2045,132 @@ int CP2130::open(uint16_t vid, uint16_t pid, const std::string &serial)
     } else if (libusb_init(&context_) != 0) {  // Initialize libusb. In case of failure
         retval = ERROR_INIT;
     } else {  // If libusb is initialized
-        if (serial.empty()) {  // Note that serial, by omission, is an empty string
-            handle_ = libusb_open_device_with_vid_pid(context_, vid, pid);  // If no serial number is specified, this will open the first device found with matching VID and PID
-        } else {
-            char *serialcstr = new char[serial.size() + 1];  // Allocated dynamically since version 1.1.0
-            std::strcpy(serialcstr, serial.c_str());
-            handle_ = libusb_open_device_with_vid_pid_serial(context_, vid, pid, reinterpret_cast<unsigned char *>(serialcstr));
-            delete[] serialcstr;
+        ownsContext_ = true;
+        retval = openDevice(vid, pid, serial);
+        if (retval != SUCCESS) {
+            libusb_exit(context_);  // Deinitialize libusb
         }
-        if (handle_ == nullptr) {  // If the previous operation fails to get a device handle
+    }
+    return retval;
+}
+
+// Opens the device having the given VID, PID and, optionally, the given serial number, using the given libusb context (added in version 1.3.0)
+// The context is shared, and remains owned by the caller, which must keep it alive while the device is open
+// Note that, in this case, events regarding asynchronous transfers must be handled by the caller as well, by running libusb_handle_events*() on the context
+int CP2130::open(libusb_context *context, uint16_t vid, uint16_t pid, const std::string &serial)
+{
+    int retval;
+    if (isOpen()) {  // See the previous function for details
+        retval = SUCCESS;
+    } else if (context == nullptr) {  // A valid context is required
+        retval = ERROR_INIT;
+    } else {
+        context_ = context;
+        ownsContext_ = false;
+        retval = openDevice(vid, pid, serial);
+    }
+    return retval;
+}
+
+// Opens the device described by the given record, as returned by enumerateDevices(), and assigns its handle (added in version 1.3.0)
+// The device is located by its bus number and port path, so that no other devices are opened in the process
+int CP2130::open(const DeviceRecord &record)
+{
+    int retval;
+    if (isOpen()) {  // See open(uint16_t, uint16_t, const std::string &) for details
+        retval = SUCCESS;
+    } else if (libusb_init(&context_) != 0) {  // Initialize libusb. In case of failure
+        retval = ERROR_INIT;
+    } else {  // If libusb is initialized
+        ownsContext_ = true;
+        retval = openDevice(record.vid, record.pid, record.bus, record.ports);
+        if (retval != SUCCESS) {
             libusb_exit(context_);  // Deinitialize libusb
-            retval = ERROR_NOT_FOUND;
-        } else {  // If the device is successfully opened and a handle obtained
-            if (libusb_kernel_driver_active(handle_, 0) == 1) {  // If a kernel driver is active on the interface
-                libusb_detach_kernel_driver(handle_, 0);  // Detach the kernel driver
-                kernelWasAttached_ = true;  // Flag that the kernel driver was attached
-            } else {
-                kernelWasAttached_ = false;  // The kernel driver was not attached
-            }
-            if (libusb_claim_interface(handle_, 0) != 0) {  // Claim the interface. In case of failure
-                if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
-                    libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
-                }
-                libusb_close(handle_);  // Close the device
-                libusb_exit(context_);  // Deinitialize libusb
-                handle_ = nullptr;  // Required to mark the device as closed
-                retval = ERROR_BUSY;
-            } else {
-                disconnected_ = false;  // Note that this flag is never assumed to be true for a device that was never opened - See constructor for details!
-                retval = SUCCESS;
-            }
         }
     }
     return retval;
 }
 
+// Opens the device described by the given record, using the given libusb context (added in version 1.3.0)
+// See open(libusb_context *, uint16_t, uint16_t, const std::string &) for details regarding shared contexts
+int CP2130::open(libusb_context *context, const DeviceRecord &record)
+{
+    int retval;
+    if (isOpen()) {
+        retval = SUCCESS;
+    } else if (context == nullptr) {  // A valid context is required
+        retval = ERROR_INIT;
+    } else {
+        context_ = context;
+        ownsContext_ = false;
+        retval = openDevice(record.vid, record.pid, record.bus, record.ports);
+    }
+    return retval;
+}
+
+// Opens a device through the given transport, such as CP2130Simulator, instead of libusb (added in version 1.3.0)
+// The transport is not owned, and must remain valid until the device is closed
+// Asynchronous transfers are carried out synchronously, and hotplug-related functionality from other classes does not apply
+int CP2130::open(USBTransport *transport)
+{
+    int retval;
+    if (isOpen()) {  // See open(uint16_t, uint16_t, const std::string &) for details
+        retval = SUCCESS;
+    } else if (transport == nullptr) {  // A valid transport is required
+        retval = ERROR_INIT;
+    } else {
+        context_ = nullptr;
+        ownsContext_ = false;
+        transport_ = transport;
+        disconnected_ = false;
+        int errcnt = 0;
+        std::string errstr;
+        cacheEndpoints(errcnt, errstr);  // As in claimDevice(), the addresses are determined on first use if this fails
+        retval = SUCCESS;
+    }
+    return retval;
+}
+
 // Issues a reset to the CP2130
 void CP2130::reset(int &errcnt, std::string &errstr)
 {
     controlTransfer(SET, RESET_DEVICE, 0x0000, 0x0000, nullptr, RESET_DEVICE_WLEN, errcnt, errstr);
 }
 
-// Enables the chip select of the target channel, disabling any others
-void CP2130::selectCS(uint8_t channel, int &errcnt, std::string &errstr)
+// Clears the statistics gathered so far (added in version 1.3.0)
+void CP2130::resetStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    std::fill(controlStats_.begin(), controlStats_.end(), 0);
+    std::fill(bulkStats_.begin(), bulkStats_.end(), 0);
+}
+
+// Enables the chip select of the target channel, disabling any others, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+CP2130::Status CP2130::selectCS(uint8_t channel)
 {
+    Status status = {STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
     if (channel > 10) {
-        ++errcnt;
-        errstr += "In selectCS(): SPI channel value must be between 0 and 10.\n";  // Program logic error
-    } else {
+        status.code = STATUS_INVALID_ARGUMENT;  // Program logic error
+        status.function = "selectCS";
+        status.detail = "SPI channel value must be between 0 and 10.";
+    } else if (csKnown_ != CS_ALLCHANNELS || csState_ != 0x0001 << channel) {  // Since version 1.3.0, the request is skipped if only the chip select of the target channel is known to be enabled already (see invalidateCS())
         unsigned char controlBufferOut[SET_GPIO_CHIP_SELECT_WLEN] = {
             channel,  // Selected channel
             0x02      // Only the corresponding chip select is enabled, all the others are disabled
         };
-        controlTransfer(SET, SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut, SET_GPIO_CHIP_SELECT_WLEN, errcnt, errstr);
+        status = controlTransfer(SET, SET_GPIO_CHIP_SELECT, 0x0000, 0x0000, controlBufferOut, SET_GPIO_CHIP_SELECT_WLEN);
+    }
+    return status;
+}
+
+// Enables the chip select of the target channel, disabling any others
+// Since version 1.3.0, this function is implemented on top of the previous one
+void CP2130::selectCS(uint8_t channel, int &errcnt, std::string &errstr)
+{
+    Status status = selectCS(channel);
+    if (status.code != STATUS_OK) {
+        ++errcnt;
+        errstr += status.message();
     }
 }
 
@@ -844,19 +2268,71 @@ void CP2130::setGPIO10(bool value, int &errcnt, std::string &errstr)
     setGPIOs(BMGPIOS * value, BMGPIO10, errcnt, errstr);
 }
 
-// Sets one or more GPIO pins on the CP2130 to the intended values, according to the values and mask bitmaps
-void CP2130::setGPIOs(uint16_t bmValues, uint16_t bmMask, int &errcnt, std::string &errstr)
+// Sets one or more GPIO pins on the CP2130 to the intended values, according to the values and mask bitmaps, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+CP2130::Status CP2130::setGPIOs(uint16_t bmValues, uint16_t bmMask)
 {
     unsigned char controlBufferOut[SET_GPIO_VALUES_WLEN] = {
         static_cast<uint8_t>((BMGPIOS & bmValues) >> 8), static_cast<uint8_t>(BMGPIOS & bmValues),  // GPIO values bitmap
         static_cast<uint8_t>((BMGPIOS & bmMask) >> 8), static_cast<uint8_t>(BMGPIOS & bmMask)       // Mask bitmap
     };
-    controlTransfer(SET, SET_GPIO_VALUES, 0x0000, 0x0000, controlBufferOut, SET_GPIO_VALUES_WLEN, errcnt, errstr);
+    return controlTransfer(SET, SET_GPIO_VALUES, 0x0000, 0x0000, controlBufferOut, SET_GPIO_VALUES_WLEN);
+}
+
+// Sets one or more GPIO pins on the CP2130 to the intended values, according to the values and mask bitmaps
+// Since version 1.3.0, this function is implemented on top of the previous one
+void CP2130::setGPIOs(uint16_t bmValues, uint16_t bmMask, int &errcnt, std::string &errstr)
+{
+    Status status = setGPIOs(bmValues, bmMask);
+    if (status.code != STATUS_OK) {
+        ++errcnt;
+        errstr += status.message();
+    }
+}
+
+// Sets the timeout and retry policy of the given transfer class (added in version 1.3.0)
+// The timeout applies to each attempt, so that a synchronous transfer can take up to (retries + 1) times the timeout, plus the delays between attempts
+// Asynchronous transfers take the timeout of the corresponding class, but they are never retried
+// Retrying requests that write to the OTP ROM is not advisable, since a programming attempt that is reported as failed may have succeeded
+// This function should not be called while other threads are carrying out transfers
+void CP2130::setTransferPolicy(uint8_t transferClass, const TransferPolicy &policy, int &errcnt, std::string &errstr)
+{
+    if (transferClass > TRANSFERS_PROM) {
+        ++errcnt;
+        errstr += "In setTransferPolicy(): Transfer class must be TRANSFERS_CONTROL, TRANSFERS_BULK or TRANSFERS_PROM.\n";  // Program logic error
+    } else if (policy.timeout == 0) {
+        ++errcnt;
+        errstr += "In setTransferPolicy(): Timeout must be greater than zero.\n";  // Program logic error
+    } else if (policy.retries > RETRIES_MAX) {
+        ++errcnt;
+        errstr += "In setTransferPolicy(): Number of retries must not exceed 8.\n";  // Program logic error
+    } else if (policy.backoff > BACKOFF_MAX) {
+        ++errcnt;
+        errstr += "In setTransferPolicy(): Retry delay must not exceed 100000us.\n";  // Program logic error
+    } else {
+        timeouts_[transferClass] = policy.timeout;
+        retries_[transferClass] = policy.retries;
+        backoffs_[transferClass] = policy.backoff;
+    }
 }
 
 // Requests and reads the given number of bytes from the SPI bus, and then returns a vector
 // This is the prefered method of reading from the bus, if both endpoint addresses are known
 std::vector<uint8_t> CP2130::spiRead(uint32_t bytesToRead, uint8_t endpointInAddr, uint8_t endpointOutAddr, int &errcnt, std::string &errstr)
+{
+    std::vector<uint8_t> retdata(bytesToRead);
+    retdata.resize(spiRead(retdata.data(), bytesToRead, endpointInAddr, endpointOutAddr, errcnt, errstr));  // Since version 1.3.0, data is read directly into the returned vector, which is then trimmed to the number of bytes read
+    return retdata;
+}
+
+// This function is a shorthand version of the previous one (both endpoint addresses are automatically deduced, and cached since version 1.3.0)
+std::vector<uint8_t> CP2130::spiRead(uint32_t bytesToRead, int &errcnt, std::string &errstr)
+{
+    return spiRead(bytesToRead, getEndpointInAddr(errcnt, errstr), getEndpointOutAddr(errcnt, errstr), errcnt, errstr);
+}
+
+// Requests and reads the given number of bytes from the SPI bus into the given buffer, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+// The number of bytes read is assigned to "bytesRead", as long as a valid (non-null) pointer is passed. Unlike the next function, no read is attempted if the read command fails
+CP2130::Status CP2130::spiRead(uint8_t *buffer, uint32_t bytesToRead, uint8_t endpointInAddr, uint8_t endpointOutAddr, uint32_t *bytesRead)
 {
     unsigned char readCommandBuffer[8] = {
         0x00, 0x00,    // Reserved
@@ -867,108 +2343,270 @@ std::vector<uint8_t> CP2130::spiRead(uint32_t bytesToRead, uint8_t endpointInAdd
         static_cast<uint8_t>(bytesToRead >> 16),
         static_cast<uint8_t>(bytesToRead >> 24)
     };
+    int bytesReadSigned = 0;  // Important!
 #if LIBUSB_API_VERSION >= 0x01000105
-    bulkTransfer(endpointOutAddr, readCommandBuffer, static_cast<int>(sizeof(readCommandBuffer)), nullptr, errcnt, errstr);
+    Status status = bulkTransfer(endpointOutAddr, readCommandBuffer, static_cast<int>(sizeof(readCommandBuffer)), nullptr);
 #else
     int bytesWritten;
-    bulkTransfer(endpointOutAddr, readCommandBuffer, static_cast<int>(sizeof(readCommandBuffer)), &bytesWritten, errcnt, errstr);
+    Status status = bulkTransfer(endpointOutAddr, readCommandBuffer, static_cast<int>(sizeof(readCommandBuffer)), &bytesWritten);
 #endif
-    unsigned char *readInputBuffer = new unsigned char[bytesToRead];  // Allocated dynamically since version 1.1.0
-    int bytesRead = 0;  // Important!
-    bulkTransfer(endpointInAddr, readInputBuffer, static_cast<int>(bytesToRead), &bytesRead, errcnt, errstr);
-    std::vector<uint8_t> retdata(static_cast<size_t>(bytesRead));
-    for (int i = 0; i < bytesRead; ++i) {
-        retdata[i] = readInputBuffer[i];
+    if (status.code == STATUS_OK) {
+        status = bulkTransfer(endpointInAddr, buffer, static_cast<int>(bytesToRead), &bytesReadSigned);
     }
-    delete[] readInputBuffer;
-    return retdata;
+    if (bytesRead != nullptr) {
+        *bytesRead = static_cast<uint32_t>(bytesReadSigned);
+    }
+    return status;
 }
 
-// This function is a shorthand version of the previous one (both endpoint addresses are automatically deduced, at the cost of decreased speed)
-std::vector<uint8_t> CP2130::spiRead(uint32_t bytesToRead, int &errcnt, std::string &errstr)
+// Requests and reads the given number of bytes from the SPI bus into the given buffer, and then returns the number of bytes read (added in version 1.3.0)
+// This function performs no allocations, and "buffer" must be able to hold at least "bytesToRead" bytes
+uint32_t CP2130::spiRead(uint8_t *buffer, uint32_t bytesToRead, uint8_t endpointInAddr, uint8_t endpointOutAddr, int &errcnt, std::string &errstr)
 {
-    return spiRead(bytesToRead, getEndpointInAddr(errcnt, errstr), getEndpointOutAddr(errcnt, errstr), errcnt, errstr);
+    unsigned char readCommandBuffer[8] = {
+        0x00, 0x00,    // Reserved
+        CP2130::READ,  // Read command
+        0x00,          // Reserved
+        static_cast<uint8_t>(bytesToRead),
+        static_cast<uint8_t>(bytesToRead >> 8),
+        static_cast<uint8_t>(bytesToRead >> 16),
+        static_cast<uint8_t>(bytesToRead >> 24)
+    };
+#if LIBUSB_API_VERSION >= 0x01000105
+    bulkTransfer(endpointOutAddr, readCommandBuffer, static_cast<int>(sizeof(readCommandBuffer)), nullptr, errcnt, errstr);
+#else
+    int bytesWritten;
+    bulkTransfer(endpointOutAddr, readCommandBuffer, static_cast<int>(sizeof(readCommandBuffer)), &bytesWritten, errcnt, errstr);
+#endif
+    int bytesRead = 0;  // Important!
+    bulkTransfer(endpointInAddr, buffer, static_cast<int>(bytesToRead), &bytesRead, errcnt, errstr);
+    return static_cast<uint32_t>(bytesRead);
 }
 
 // Writes to the SPI bus, using the given vector
 // This is the prefered method of writing to the bus, if the endpoint OUT address is known
 void CP2130::spiWrite(const std::vector<uint8_t> &data, uint8_t endpointOutAddr, int &errcnt, std::string &errstr)
 {
-    uint32_t bytesToWrite = static_cast<uint32_t>(data.size());
-    int bufSize = bytesToWrite + 8;
-    unsigned char *writeCommandBuffer = new unsigned char[bufSize] {  // Allocated dynamically since version 1.1.0
-        0x00, 0x00,     // Reserved
-        CP2130::WRITE,  // Write command
-        0x00,           // Reserved
-        static_cast<uint8_t>(bytesToWrite),
-        static_cast<uint8_t>(bytesToWrite >> 8),
-        static_cast<uint8_t>(bytesToWrite >> 16),
-        static_cast<uint8_t>(bytesToWrite >> 24)
-    };
-    for (size_t i = 0; i < bytesToWrite; ++i) {
-        writeCommandBuffer[i + 8] = data[i];
+    spiWrite(data.data(), data.size(), endpointOutAddr, errcnt, errstr);  // Refactored in version 1.3.0
+}
+
+// Writes to the SPI bus, using the given number of bytes pointed by "data", returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.3.0)
+// The write command is assembled in a scratch buffer that is kept by the object, so that no allocations take place once the buffer is large enough
+// Note that, due to the use of this buffer, calls to this function are not thread-safe
+CP2130::Status CP2130::spiWrite(const uint8_t *data, size_t size, uint8_t endpointOutAddr)
+{
+    uint32_t bytesToWrite = static_cast<uint32_t>(size);
+    size_t bufSize = size + 8;
+    if (scratch_.size() < bufSize) {
+        scratch_.resize(bufSize);  // The scratch buffer only grows
     }
+    unsigned char *writeCommandBuffer = scratch_.data();
+    writeCommandBuffer[0] = 0x00;           // Reserved
+    writeCommandBuffer[1] = 0x00;           // Reserved
+    writeCommandBuffer[2] = CP2130::WRITE;  // Write command
+    writeCommandBuffer[3] = 0x00;           // Reserved
+    writeCommandBuffer[4] = static_cast<uint8_t>(bytesToWrite);
+    writeCommandBuffer[5] = static_cast<uint8_t>(bytesToWrite >> 8);
+    writeCommandBuffer[6] = static_cast<uint8_t>(bytesToWrite >> 16);
+    writeCommandBuffer[7] = static_cast<uint8_t>(bytesToWrite >> 24);
+    std::copy(data, data + size, writeCommandBuffer + 8);
 #if LIBUSB_API_VERSION >= 0x01000105
-    bulkTransfer(endpointOutAddr, writeCommandBuffer, bufSize, nullptr, errcnt, errstr);
+    return bulkTransfer(endpointOutAddr, writeCommandBuffer, static_cast<int>(bufSize), nullptr);
 #else
     int bytesWritten;
-    bulkTransfer(endpointOutAddr, writeCommandBuffer, bufSize, &bytesWritten, errcnt, errstr);
+    return bulkTransfer(endpointOutAddr, writeCommandBuffer, static_cast<int>(bufSize), &bytesWritten);
 #endif
-    delete[] writeCommandBuffer;
 }
 
-// This function is a shorthand version of the previous one (the endpoint OUT address is automatically deduced at the cost of decreased speed)
+// Writes to the SPI bus, using the given number of bytes pointed by "data" (added in version 1.3.0)
+// This function is implemented on top of the previous one, and the same considerations apply
+void CP2130::spiWrite(const uint8_t *data, size_t size, uint8_t endpointOutAddr, int &errcnt, std::string &errstr)
+{
+    Status status = spiWrite(data, size, endpointOutAddr);
+    if (status.code != STATUS_OK) {
+        ++errcnt;
+        errstr += status.message();
+    }
+}
+
+// This function is a shorthand version of the previous one (the endpoint OUT address is automatically deduced, and cached since version 1.3.0)
 void CP2130::spiWrite(const std::vector<uint8_t> &data, int &errcnt, std::string &errstr)
 {
     spiWrite(data, getEndpointOutAddr(errcnt, errstr), errcnt, errstr);
 }
 
+// Writes asynchronously to the SPI bus, using the given number of bytes pointed by "data", and invokes the given callback on completion (added in version 1.3.0)
+// This allows several writes to be queued, without waiting for each one to complete
+// The data is copied into the write command buffer, which is owned by the transfer, so that it does not need to remain valid after this function returns
+void CP2130::spiWriteAsync(const uint8_t *data, size_t size, uint8_t endpointOutAddr, const TransferCallback &callback, int &errcnt, std::string &errstr)
+{
+    uint32_t bytesToWrite = static_cast<uint32_t>(size);
+    std::shared_ptr<std::vector<uint8_t>> writeCommandBuffer = std::make_shared<std::vector<uint8_t>>(size + 8);  // Shared with the callback, so that it remains valid until the transfer completes
+    (*writeCommandBuffer)[0] = 0x00;           // Reserved
+    (*writeCommandBuffer)[1] = 0x00;           // Reserved
+    (*writeCommandBuffer)[2] = CP2130::WRITE;  // Write command
+    (*writeCommandBuffer)[3] = 0x00;           // Reserved
+    (*writeCommandBuffer)[4] = static_cast<uint8_t>(bytesToWrite);
+    (*writeCommandBuffer)[5] = static_cast<uint8_t>(bytesToWrite >> 8);
+    (*writeCommandBuffer)[6] = static_cast<uint8_t>(bytesToWrite >> 16);
+    (*writeCommandBuffer)[7] = static_cast<uint8_t>(bytesToWrite >> 24);
+    std::copy(data, data + size, writeCommandBuffer->begin() + 8);
+    bulkTransferAsync(endpointOutAddr, writeCommandBuffer->data(), static_cast<int>(writeCommandBuffer->size()), [writeCommandBuffer, callback](int status, int transferred) {
+        if (callback) {
+            callback(status, transferred);
+        }
+    }, errcnt, errstr);
+}
+
+// Writes asynchronously to the SPI bus, using the given vector, and invokes the given callback on completion (added in version 1.3.0)
+// This function is implemented on top of the previous one, and the same considerations apply
+void CP2130::spiWriteAsync(const std::vector<uint8_t> &data, uint8_t endpointOutAddr, const TransferCallback &callback, int &errcnt, std::string &errstr)
+{
+    spiWriteAsync(data.data(), data.size(), endpointOutAddr, callback, errcnt, errstr);
+}
+
+// Future-based version of the previous function (added in version 1.3.0)
+std::future<CP2130::TransferResult> CP2130::spiWriteAsync(const std::vector<uint8_t> &data, uint8_t endpointOutAddr, int &errcnt, std::string &errstr)
+{
+    std::shared_ptr<std::promise<TransferResult>> promise = std::make_shared<std::promise<TransferResult>>();
+    std::future<TransferResult> future = promise->get_future();
+    int preverrcnt = errcnt;
+    spiWriteAsync(data, endpointOutAddr, [promise](int status, int transferred) {
+        promise->set_value(TransferResult{status, transferred, std::vector<uint8_t>()});
+    }, errcnt, errstr);
+    if (errcnt != preverrcnt) {  // If the transfer could not be submitted, the future is fulfilled right away
+        promise->set_value(TransferResult{LIBUSB_TRANSFER_ERROR, 0, std::vector<uint8_t>()});
+    }
+    return future;
+}
+
 // Writes to the SPI bus while reading back, returning a vector of the same size as the one given
 // This is the prefered method of writing and reading, if both endpoint addresses are known
+// Since version 1.3.0, the WriteRead commands are pipelined using asynchronous transfers, so that the next commands are already queued while the data returned by the previous ones is being read
+// This does not apply to devices opened using a shared libusb context, nor to calls made from a transfer callback, for which the commands are issued one by one, using synchronous transfers
 std::vector<uint8_t> CP2130::spiWriteRead(const std::vector<uint8_t> &data, uint8_t endpointInAddr, uint8_t endpointOutAddr, int &errcnt, std::string &errstr)
 {
     size_t bytesToWriteRead = data.size();
-    size_t bytesProcessed = 0;  // Loop control variable implemented in version 1.2.3, to replace "bytesLeft"
-    std::vector<uint8_t> retdata;
-    int preverrcnt = errcnt;
-    while (bytesProcessed < bytesToWriteRead && preverrcnt == errcnt) {  // The extra condition breaks the loop in case of error (added in version 1.2.4)
-        size_t bytesRemaining = bytesToWriteRead - bytesProcessed;  // Equivalent to the variable "bytesLeft" found in version 1.2.2, except that it is no longer used for control
-        uint32_t payload = static_cast<uint32_t>(bytesRemaining > 56 ? 56 : bytesRemaining);
-        int bufSize = payload + 8;
-        unsigned char *writeReadCommandBuffer = new unsigned char[bufSize] {
-            0x00, 0x00,         // Reserved
-            CP2130::WRITEREAD,  // WriteRead command
-            0x00,               // Reserved
-            static_cast<uint8_t>(payload),
-            static_cast<uint8_t>(payload >> 8),
-            static_cast<uint8_t>(payload >> 16),
-            static_cast<uint8_t>(payload >> 24)
-        };
-        for (size_t i = 0; i < payload; ++i) {
-            writeReadCommandBuffer[i + 8] = data[bytesProcessed + i];
+    size_t nchunks = (bytesToWriteRead + WR_PAYLOAD - 1) / WR_PAYLOAD;
+    size_t bufSize = 8 * nchunks + bytesToWriteRead + WR_INDEPTH * WR_PACKETSIZE;  // Room for every WriteRead command, followed by one packet-sized slot per queued IN transfer
+    if (scratch_.size() < bufSize) {
+        scratch_.resize(bufSize);  // The scratch buffer only grows
+    }
+    unsigned char *writeReadCommandBuffer = scratch_.data();
+    unsigned char *writeReadInputBuffer = writeReadCommandBuffer + 8 * nchunks + bytesToWriteRead;
+    size_t commandOffset = 0;
+    for (size_t bytesProcessed = 0; bytesProcessed < bytesToWriteRead; bytesProcessed += WR_PAYLOAD) {  // Assemble all WriteRead commands beforehand
+        size_t bytesRemaining = bytesToWriteRead - bytesProcessed;
+        uint32_t payload = static_cast<uint32_t>(bytesRemaining > WR_PAYLOAD ? WR_PAYLOAD : bytesRemaining);
+        unsigned char *command = writeReadCommandBuffer + commandOffset;
+        command[0] = 0x00;               // Reserved
+        command[1] = 0x00;               // Reserved
+        command[2] = CP2130::WRITEREAD;  // WriteRead command
+        command[3] = 0x00;               // Reserved
+        command[4] = static_cast<uint8_t>(payload);
+        command[5] = static_cast<uint8_t>(payload >> 8);
+        command[6] = static_cast<uint8_t>(payload >> 16);
+        command[7] = static_cast<uint8_t>(payload >> 24);
+        std::copy(data.begin() + bytesProcessed, data.begin() + bytesProcessed + payload, command + 8);
+        commandOffset += payload + 8;
+    }
+    std::vector<uint8_t> retdata(bytesToWriteRead);  // The returned vector is sized only once, and trimmed at the end if needed
+    size_t bytesRead = 0;
+    if (handle_ == nullptr || (ownsContext_ && eventThread_.get_id() != std::this_thread::get_id() && callbackThread_.load() != std::this_thread::get_id())) {  // Pipelining relies on the event handling thread, which must not be the caller
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t outPending = 0, inPending = 0, inSlot = 0;
+        size_t bytesCommanded = 0;
+        int failedEndpointAddr = -1;
+        size_t chunk = 0;
+        commandOffset = 0;
+        bool submitFailed = false;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!submitFailed && failedEndpointAddr < 0 && bytesRead < bytesToWriteRead) {
+            if (chunk < nchunks && bytesCommanded - bytesRead < WR_WINDOW) {  // Queue the next WriteRead command, as long as the amount of data yet to be read stays within the window
+                size_t bytesRemaining = bytesToWriteRead - chunk * WR_PAYLOAD;
+                int length = static_cast<int>((bytesRemaining > WR_PAYLOAD ? WR_PAYLOAD : bytesRemaining) + 8);
+                unsigned char *command = writeReadCommandBuffer + commandOffset;
+                ++outPending;
+                bytesCommanded += length - 8;
+                commandOffset += length;
+                ++chunk;
+                lock.unlock();  // The lock is released while submitting, so that callbacks are never held back
+                int preverrcnt = errcnt;
+                bulkTransferAsync(endpointOutAddr, command, length, [&, length, endpointOutAddr](int status, int transferred) {
+                    std::lock_guard<std::mutex> callbackLock(mutex);
+                    if (status != LIBUSB_TRANSFER_COMPLETED || transferred != length) {
+                        failedEndpointAddr = endpointOutAddr;
+                    }
+                    --outPending;
+                    condition.notify_one();
+                }, errcnt, errstr);
+                lock.lock();
+                if (errcnt != preverrcnt) {  // Submission failure, which is already reported by bulkTransferAsync()
+                    --outPending;
+                    submitFailed = true;
+                }
+            } else if (inPending < WR_INDEPTH && inPending < (bytesCommanded - bytesRead + WR_PACKETSIZE - 1) / WR_PACKETSIZE) {  // Each IN transfer receives exactly one packet, so only as many transfers are queued as the number of packets that are certainly due
+                unsigned char *slot = writeReadInputBuffer + WR_PACKETSIZE * inSlot;
+                inSlot = (inSlot + 1) % WR_INDEPTH;  // Transfers complete in order, hence a slot is only reused after its previous transfer has completed
+                ++inPending;
+                lock.unlock();
+                int preverrcnt = errcnt;
+                bulkTransferAsync(endpointInAddr, slot, static_cast<int>(WR_PACKETSIZE), [&, slot, endpointInAddr](int status, int transferred) {
+                    std::lock_guard<std::mutex> callbackLock(mutex);
+                    if (status != LIBUSB_TRANSFER_COMPLETED) {
+                        failedEndpointAddr = endpointInAddr;
+                    } else {
+                        size_t bytesToCopy = static_cast<size_t>(transferred) > bytesToWriteRead - bytesRead ? bytesToWriteRead - bytesRead : static_cast<size_t>(transferred);
+                        std::copy(slot, slot + bytesToCopy, retdata.begin() + bytesRead);  // Transfers from the same endpoint complete in order, so the data is simply appended
+                        bytesRead += bytesToCopy;
+                    }
+                    --inPending;
+                    condition.notify_one();
+                }, errcnt, errstr);
+                lock.lock();
+                if (errcnt != preverrcnt) {
+                    --inPending;
+                    submitFailed = true;
+                }
+            } else {
+                condition.wait(lock);  // Nothing else can be queued for now, so wait for a transfer to complete
+            }
         }
-#if LIBUSB_API_VERSION >= 0x01000105
-        bulkTransfer(endpointOutAddr, writeReadCommandBuffer, bufSize, nullptr, errcnt, errstr);
-#else
-        int bytesWritten;
-        bulkTransfer(endpointOutAddr, writeReadCommandBuffer, bufSize, &bytesWritten, errcnt, errstr);
-#endif
-        delete[] writeReadCommandBuffer;
-        unsigned char *writeReadInputBuffer = new unsigned char[payload];
-        int bytesRead = 0;  // Important!
-        bulkTransfer(endpointInAddr, writeReadInputBuffer, payload, &bytesRead, errcnt, errstr);
-        size_t prevretdataSize = retdata.size();
-        retdata.resize(static_cast<size_t>(prevretdataSize + bytesRead));  // Optimization implemented in version 1.2.2, and fixed in version 1.2.3
-        for (int i = 0; i < bytesRead; ++i) {
-            retdata[prevretdataSize + i] = writeReadInputBuffer[i];  // Note that std::vector::push_back() is no longer used since version 1.2.2, because it is more efficient to resize the vector only once per iteration (see above), so that the values may be simply assigned (fixed in version 1.2.3)
+        condition.wait(lock, [&] { return outPending == 0 && inPending == 0; });  // Any transfers still in flight refer to local variables, thus they must complete before returning
+        lock.unlock();
+        if (failedEndpointAddr >= 0) {
+            ++errcnt;
+            std::ostringstream stream;
+            stream << "Failed bulk "
+                   << (failedEndpointAddr < 0x80 ? "OUT transfer to" : "IN transfer from")
+                   << " endpoint "
+                   << (0x0f & failedEndpointAddr)
+                   << " (address 0x"
+                   << std::hex << std::setfill ('0') << std::setw(2) << failedEndpointAddr
+                   << ")." << std::endl;
+            errstr += stream.str();
+        }
+    } else {  // With a shared context, events might not be handled while this function waits, and a callback cannot wait for other callbacks, so the WriteRead commands are instead issued one at a time, synchronously, as before version 1.3.0
+        int preverrcnt = errcnt;
+        commandOffset = 0;
+        while (bytesRead < bytesToWriteRead && errcnt == preverrcnt) {  // The loop is interrupted in case of error
+            size_t bytesRemaining = bytesToWriteRead - bytesRead;
+            int payload = static_cast<int>(bytesRemaining > WR_PAYLOAD ? WR_PAYLOAD : bytesRemaining);
+            bulkTransfer(endpointOutAddr, writeReadCommandBuffer + commandOffset, payload + 8, nullptr, errcnt, errstr);
+            commandOffset += payload + 8;
+            if (errcnt == preverrcnt) {
+                int transferred = 0;
+                bulkTransfer(endpointInAddr, retdata.data() + bytesRead, payload, &transferred, errcnt, errstr);
+                bytesRead += static_cast<size_t>(transferred);
+            }
         }
-        delete[] writeReadInputBuffer;
-        bytesProcessed += payload;  // Note that, since version 1.2.3, the loop control variable is added to (it is generaly a bad idea to subtract from a unsigned variable, because it can lead to a overflow that may go unchecked)
     }
+    retdata.resize(bytesRead);
     return retdata;
 }
 
-// This function is a shorthand version of the previous one (both endpoint addresses are automatically deduced, at the cost of decreased speed)
+// This function is a shorthand version of the previous one (both endpoint addresses are automatically deduced, and cached since version 1.3.0)
 std::vector<uint8_t> CP2130::spiWriteRead(const std::vector<uint8_t> &data, int &errcnt, std::string &errstr)
 {
     return spiWriteRead(data, getEndpointInAddr(errcnt, errstr), getEndpointOutAddr(errcnt, errstr), errcnt, errstr);
@@ -1039,15 +2677,23 @@ void CP2130::writeProductDesc(const std::u16string &product, int &errcnt, std::s
 }
 
 // Writes over the entire CP2130 OTP ROM
+// Since version 1.3.0, blocks that are identical to the current ones are skipped
+// The cached copy of the OTP ROM is discarded by the writes, rather than replaced by the given configuration, since the contents of an OTP memory may not match what was written
 void CP2130::writePROMConfig(const PROMConfig &config, int &errcnt, std::string &errstr)
 {
+    int readerrcnt = 0;
+    std::string readerrstr;
+    PROMConfig current = getPROMConfig(readerrcnt, readerrstr);  // Since version 1.3.0, only the blocks that differ from the current contents are written, unless the current contents cannot be read
     for (size_t i = 0; i < PROM_BLOCKS; ++i) {
-        unsigned char controlBufferOut[SET_PROM_CONFIG_WLEN];
-        for (size_t j = 0; j < PROM_BLOCK_SIZE; ++j) {
-            controlBufferOut[j] = config.blocks[i][j];
+        if (readerrcnt != 0 || !std::equal(config.blocks[i], config.blocks[i] + PROM_BLOCK_SIZE, current.blocks[i])) {
+            unsigned char controlBufferOut[SET_PROM_CONFIG_WLEN];
+            for (size_t j = 0; j < PROM_BLOCK_SIZE; ++j) {
+                controlBufferOut[j] = config.blocks[i][j];
+            }
+            controlTransfer(SET, SET_PROM_CONFIG, PROM_WRITE_KEY, static_cast<uint16_t>(i), controlBufferOut, SET_PROM_CONFIG_WLEN, errcnt, errstr);
         }
-        controlTransfer(SET, SET_PROM_CONFIG, PROM_WRITE_KEY, static_cast<uint16_t>(i), controlBufferOut, SET_PROM_CONFIG_WLEN, errcnt, errstr);
     }
+    endpointsCached_ = false;  // The transfer priority may have changed, so the endpoint addresses must be determined again (implemented in version 1.3.0)
 }
 
 // Writes the serial descriptor to the CP2130 OTP ROM
@@ -1074,12 +2720,80 @@ void CP2130::writeUSBConfig(const USBConfig &config, uint8_t mask, int &errcnt,
         mask                                                                      // Write mask (can be obtained using the return value of getLockWord(), after being bitwise ANDed with "LWUSBCFG" [0x009f] and the resulting value cast to uint8_t)
     };
     controlTransfer(SET, SET_USB_CONFIG, PROM_WRITE_KEY, 0x0000, controlBufferOut, SET_USB_CONFIG_WLEN, errcnt, errstr);
+    endpointsCached_ = false;  // The transfer priority may have changed, so the endpoint addresses must be determined again (implemented in version 1.3.0)
+}
+
+// Helper function to enumerate devices, returning one record per device found (added in version 1.3.0)
+// Each device is opened only once, in order to get its serial number, and the returned records can be passed to open() without scanning the bus again
+std::vector<CP2130::DeviceRecord> CP2130::enumerateDevices(uint16_t vid, uint16_t pid, int &errcnt, std::string &errstr)
+{
+    std::vector<DeviceRecord> devices;
+    libusb_context *context;
+    if (libusb_init(&context) != 0) {  // Initialize libusb. In case of failure
+        ++errcnt;
+        errstr += "Could not initialize libusb.\n";
+    } else {  // If libusb is initialized
+        devices = enumerateDevices(context, vid, pid, errcnt, errstr);
+        libusb_exit(context);  // Deinitialize libusb
+    }
+    return devices;
+}
+
+// Same as the previous function, but using the given libusb context (added in version 1.3.0)
+std::vector<CP2130::DeviceRecord> CP2130::enumerateDevices(libusb_context *context, uint16_t vid, uint16_t pid, int &errcnt, std::string &errstr)
+{
+    std::vector<DeviceRecord> devices;
+    enumerateDevices(context, vid, pid, devices, errcnt, errstr);
+    return devices;
+}
+
+// Same as the previous function, but writing the records to the given vector, whose existing records are reused, along with the storage of their strings (added in version 1.3.0)
+// Scanning repeatedly with the same vector causes no allocations, other than the ones done by libusb, as long as the number of devices does not grow
+void CP2130::enumerateDevices(libusb_context *context, uint16_t vid, uint16_t pid, std::vector<DeviceRecord> &devices, int &errcnt, std::string &errstr)
+{
+    size_t count = 0;
+    libusb_device **devs;
+    ssize_t devlist = libusb_get_device_list(context, &devs);  // Get a device list
+    if (devlist < 0) {  // If the previous operation fails to get a device list
+        ++errcnt;
+        errstr += "Failed to retrieve a list of devices.\n";
+    } else {
+        for (ssize_t i = 0; i < devlist; ++i) {  // Run through all listed devices
+            if (count == devices.size()) {
+                devices.push_back(DeviceRecord());  // Spare record, which is discarded below if no further devices match
+            }
+            DeviceRecord &record = devices[count];  // Since version 1.3.0, a record is reused if available
+            if (readDeviceSerial(devs[i], vid, pid, record.serial)) {  // The serial number is left empty if it could not be retrieved (fixed in version 1.3.0)
+                uint8_t ports[7];  // As per the USB 3.0 specification, the current maximum limit for the depth is 7
+                int nports = libusb_get_port_numbers(devs[i], ports, static_cast<int>(sizeof(ports)));
+                record.vid = vid;
+                record.pid = pid;
+                record.bus = libusb_get_bus_number(devs[i]);
+                record.ports.assign(ports, ports + (nports < 0 ? 0 : nports));
+                ++count;
+            }
+        }
+        libusb_free_device_list(devs, 1);  // Free device list
+    }
+    devices.resize(count);  // Any records left over from a previous scan are discarded
 }
 
 // Helper function to list devices
 std::list<std::string> CP2130::listDevices(uint16_t vid, uint16_t pid, int &errcnt, std::string &errstr)
 {
+    std::vector<DeviceRecord> records = enumerateDevices(vid, pid, errcnt, errstr);  // Refactored in version 1.3.0
     std::list<std::string> devices;
+    for (size_t i = 0; i < records.size(); ++i) {
+        devices.push_back(records[i].serial);  // Add the serial number string to the list
+    }
+    return devices;
+}
+
+// Helper function to list devices into the given vector, replacing its contents (added in version 1.3.0)
+// Unlike the previous function, the serial numbers are written straight into the existing strings of the vector, so that listing repeatedly with the same vector causes no allocations, other than the ones done by libusb, as long as the number of devices does not grow
+void CP2130::listDevices(uint16_t vid, uint16_t pid, std::vector<std::string> &devices, int &errcnt, std::string &errstr)
+{
+    size_t count = 0;
     libusb_context *context;
     if (libusb_init(&context) != 0) {  // Initialize libusb. In case of failure
         ++errcnt;
@@ -1092,20 +2806,16 @@ std::list<std::string> CP2130::listDevices(uint16_t vid, uint16_t pid, int &errc
             errstr += "Failed to retrieve a list of devices.\n";
         } else {
             for (ssize_t i = 0; i < devlist; ++i) {  // Run through all listed devices
-                libusb_device_descriptor desc;
-                if (libusb_get_device_descriptor(devs[i], &desc) == 0 && desc.idVendor == vid && desc.idProduct == pid) {  // If the device descriptor is retrieved, and both VID and PID correspond to the respective given values
-                    libusb_device_handle *handle;
-                    if (libusb_open(devs[i], &handle) == 0) {  // Open the listed device. If successfull
-                        unsigned char str_desc[256];
-                        libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, str_desc, static_cast<int>(sizeof(str_desc)));  // Get the serial number string in ASCII format
-                        devices.push_back(reinterpret_cast<char *>(str_desc));  // Add the serial number string to the list
-                        libusb_close(handle);  // Close the device
-                    }
+                if (count == devices.size()) {
+                    devices.push_back(std::string());  // Spare string, which is discarded below if no further devices match
+                }
+                if (readDeviceSerial(devs[i], vid, pid, devices[count])) {
+                    ++count;
                 }
             }
             libusb_free_device_list(devs, 1);  // Free device list
         }
         libusb_exit(context);  // Deinitialize libusb
     }
-    return devices;
+    devices.resize(count);  // Any strings left over from a previous listing are discarded
 }
@@ -1,5 +1,5 @@
-/* CP2130 class - Version 1.2.6
-   Copyright (c) 2021-2024 Samuel Lourenço
+/* CP2130 class - Version 1.3.0
+   Copyright (c) 2021-2026 Samuel Lourenço
 
    This library is free software: you can redistribute it and/or modify it
    under the terms of the GNU Lesser General Public License as published by
@@ -22,22 +22,84 @@
 #define CP2130_H
 
 // Includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <list>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 #include <libusb-1.0/libusb.h>
+#include "usbtransport.h"
+
+// Coroutine support, which is only available in C++20 or later (added in version 1.3.0)
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#define CP2130_COROUTINES 1
+#include <coroutine>
+#include <memory>
+#endif
 
 class CP2130
 {
 private:
+    struct AsyncTransfer {
+        CP2130 *owner;                           // Object that submitted the transfer
+        std::function<void(int, int)> callback;  // Callback to be invoked on completion (see TransferCallback)
+        std::vector<unsigned char> buffer;       // Buffer owned by the transfer, if any (only applicable to controlReadAsync() and controlTransferAsync())
+        unsigned char *destination;              // Buffer to which the data stage is copied on completion, if any (only applicable to controlReadAsync())
+        bool control;                            // True if the transfer is a control transfer (see recordTransfer())
+        uint8_t statsIndex;                      // Request, in the case of a control transfer, or endpoint address, in the case of a bulk transfer (see recordTransfer())
+        std::chrono::steady_clock::time_point submitted;  // Submission time (only applicable if statistics are enabled)
+        std::atomic<bool> claimed;               // Set by whichever of asyncCallback() and stopEventHandling() gets to the record first, the latter only if the transfer is abandoned
+    };
+
     libusb_context *context_;
     libusb_device_handle *handle_;
-    bool disconnected_, kernelWasAttached_;
-
-    std::u16string getDescGeneric(uint8_t command, int &errcnt, std::string &errstr);
+    LibUSBTransport libusbTransport_;
+    USBTransport *transport_;
+    std::atomic<bool> disconnected_;
+    bool kernelWasAttached_, endpointsCached_, ownsContext_;
+    uint8_t endpointInAddr_, endpointOutAddr_;
+    uint16_t csKnown_, csState_;  // Bitmaps of the chip selects whose state is known, and of the ones known to be enabled (see trackRequest())
+    std::vector<uint8_t> prom_;   // Cached copy of the OTP ROM, which is empty if not cached (see getPROMConfig())
+    std::thread eventThread_;
+    std::atomic<std::thread::id> callbackThread_;  // Thread that is running a callback, if any (see stopEventHandling())
+    std::atomic<bool> stopEvents_;
+    std::mutex asyncMutex_;
+    std::condition_variable asyncCondition_;
+    std::set<libusb_transfer *> pendingTransfers_;
+    std::vector<unsigned char> scratch_;
+    std::atomic<bool> statsEnabled_;
+    mutable std::mutex statsMutex_;
+    std::vector<uint64_t> controlStats_, bulkStats_;  // Statistics tables, indexed by request or by endpoint address, and allocated on first use (see recordTransfer())
+    unsigned int timeouts_[3], backoffs_[3];          // Timeouts and initial retry delays, one per transfer class (see TransferPolicy)
+    uint8_t retries_[3];                              // Maximum number of retries, one per transfer class
+
+    void cacheEndpoints(int &errcnt, std::string &errstr);
+    int claimDevice();
+    void getDescGeneric(uint8_t command, std::u16string &descriptor, int &errcnt, std::string &errstr);
+    void getPROMField(uint8_t bRequest, unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr);
+    void handleEvents();
+    int openDevice(uint16_t vid, uint16_t pid, const std::string &serial);
+    int openDevice(uint16_t vid, uint16_t pid, uint8_t bus, const std::vector<uint8_t> &ports);
+    void recordTransfer(bool control, uint8_t index, int bytes, bool failed, bool timedOut, const std::chrono::steady_clock::time_point &start);
+    void startEventHandling();
+    bool stopEventHandling();
+    void trackRequest(uint8_t bmRequestType, uint8_t bRequest, const unsigned char *data, uint16_t wLength, bool succeeded);
     void writeDescGeneric(const std::u16string &descriptor, uint8_t command, int &errcnt, std::string &errstr);
 
+    static void LIBUSB_CALL asyncCallback(libusb_transfer *transfer);
+    static bool isRetryable(int result);
+    static bool readDeviceSerial(libusb_device *device, uint16_t vid, uint16_t pid, std::string &serial);
+    static uint8_t transferClass(uint8_t bRequest);
+    static int transferStatus(int result);
+
 public:
     // Class definitions
     static const uint16_t VID = 0x10c4;    // Default USB vendor ID
@@ -47,6 +109,25 @@ public:
     static const int ERROR_NOT_FOUND = 2;  // Returned by open() if the device was not found
     static const int ERROR_BUSY = 3;       // Returned by open() if the device is already in use
 
+    // The following values are applicable to Status (added in version 1.3.0)
+    static const int STATUS_OK = 0;                // Operation successful
+    static const int STATUS_NOT_OPEN = 1;          // Device is not open (program logic error)
+    static const int STATUS_INVALID_ARGUMENT = 2;  // Invalid argument (program logic error)
+    static const int STATUS_CONTROL_FAILED = 3;    // Failed control transfer
+    static const int STATUS_BULK_FAILED = 4;       // Failed bulk transfer
+
+    // Number of bins of each latency histogram (see Metrics - added in version 1.3.0)
+    static const size_t STATS_BINS = 16;
+
+    // Transfer classes applicable to getTransferPolicy() and setTransferPolicy() (added in version 1.3.0)
+    static const uint8_t TRANSFERS_CONTROL = 0;  // Control transfers, other than the ones listed below
+    static const uint8_t TRANSFERS_BULK = 1;     // Bulk transfers
+    static const uint8_t TRANSFERS_PROM = 2;     // Control transfers that access the OTP ROM ("Get_USB_Config" to "Set_PROM_Config" requests)
+
+    // Limits applicable to TransferPolicy (added in version 1.3.0)
+    static const uint8_t RETRIES_MAX = 8;            // Maximum number of retries
+    static const unsigned int BACKOFF_MAX = 100000;  // Maximum initial retry delay, in microseconds
+
     // Descriptor specific definitions
     static const size_t DESCMXL_MANUFACTURER = 62;  // Maximum length of manufacturer descriptor
     static const size_t DESCMXL_PRODUCT = 62;       // Maximum length of product descriptor
@@ -242,6 +323,21 @@ public:
     static const uint8_t PRIOREAD = 0x00;     // Value corresponding to data transfer with high priority read
     static const uint8_t PRIOWRITE = 0x01;    // Value corresponding to data transfer with high priority write
 
+    // Callback applicable to bulkTransferAsync(), controlReadAsync(), controlTransferAsync() and spiWriteAsync(), which receives the transfer status (LIBUSB_TRANSFER_COMPLETED if successful) and the number of bytes transferred
+    // Note that callbacks are invoked from the event handling thread, so they should return quickly, and they must not close the device (see close())
+    typedef std::function<void(int status, int transferred)> TransferCallback;
+
+    struct DeviceRecord {
+        uint16_t vid;                // Vendor ID
+        uint16_t pid;                // Product ID
+        uint8_t bus;                 // Bus number
+        std::vector<uint8_t> ports;  // Port numbers, from the root hub down to the device
+        std::string serial;          // Serial number
+
+        bool operator ==(const DeviceRecord &other) const;
+        bool operator !=(const DeviceRecord &other) const;
+    };
+
     struct EventCounter {
         bool overflow;   // Overflow flag
         uint8_t mode;    // GPIO.4/EVTCNTR pin mode (see the values applicable to PinConfig/getPinConfig()/writePinConfig())
@@ -251,6 +347,21 @@ public:
         bool operator !=(const EventCounter &other) const;
     };
 
+    // Metrics of the transfers regarding a given request or endpoint, as found in Stats (added in version 1.3.0)
+    // Latencies are measured from submission to completion, and histogram[i] counts latencies of at least 2^i microseconds and less than 2^(i + 1) microseconds, except for the first bin, which also counts latencies below 1us, and the last one, which counts every latency above that range
+    struct Metrics {
+        uint64_t calls;                  // Number of transfers
+        uint64_t bytes;                  // Number of bytes transferred
+        uint64_t errors;                 // Number of failed transfers, including the ones that timed out
+        uint64_t timeouts;               // Number of transfers that timed out
+        uint64_t totalLatency;           // Sum of all latencies, in microseconds
+        uint64_t maxLatency;             // Maximum latency, in microseconds
+        uint64_t histogram[STATS_BINS];  // Latency histogram
+
+        bool operator ==(const Metrics &other) const;
+        bool operator !=(const Metrics &other) const;
+    };
+
     struct PinConfig {
         uint8_t gpio0;       // GPIO.0 pin config
         uint8_t gpio1;       // GPIO.1 pin config
@@ -313,6 +424,48 @@ public:
         bool operator !=(const SPIMode &other) const;
     };
 
+    // Transfer statistics, as returned by getStats() (added in version 1.3.0)
+    struct Stats {
+        std::map<uint8_t, Metrics> control;  // Statistics of the control transfers, per request (only requests that were issued are included)
+        std::map<uint8_t, Metrics> bulk;     // Statistics of the bulk transfers, per endpoint address (only endpoints that were used are included)
+
+        bool operator ==(const Stats &other) const;
+        bool operator !=(const Stats &other) const;
+    };
+
+    struct Status {
+        int code;               // Status code (STATUS_OK if successful)
+        int result;             // Value returned by libusb, if applicable
+        const char *function;   // Name of the function that detected a program logic error, if applicable
+        const char *detail;     // Description of the program logic error, if applicable
+        uint8_t bmRequestType;  // Request type of the failed control transfer, if applicable
+        uint8_t bRequest;       // Request of the failed control transfer, if applicable
+        uint8_t endpointAddr;   // Endpoint address of the failed bulk transfer, if applicable
+
+        bool operator ==(const Status &other) const;
+        bool operator !=(const Status &other) const;
+        std::string message() const;
+    };
+
+    // Timeout and retry policy of a given transfer class, as returned by getTransferPolicy() (added in version 1.3.0)
+    struct TransferPolicy {
+        unsigned int timeout;  // Timeout of each attempt, in milliseconds
+        uint8_t retries;       // Maximum number of retries of a failed attempt (up to RETRIES_MAX)
+        unsigned int backoff;  // Delay before the first retry, in microseconds (up to BACKOFF_MAX), which doubles before each subsequent retry
+
+        bool operator ==(const TransferPolicy &other) const;
+        bool operator !=(const TransferPolicy &other) const;
+    };
+
+    struct TransferResult {
+        int status;                 // Transfer status (LIBUSB_TRANSFER_COMPLETED if successful)
+        int transferred;            // Number of bytes transferred
+        std::vector<uint8_t> data;  // Data read from the device (only applicable to bulkReadAsync())
+
+        bool operator ==(const TransferResult &other) const;
+        bool operator !=(const TransferResult &other) const;
+    };
+
     struct USBConfig {
         uint16_t vid;     // Vendor ID (little-endian)
         uint16_t pid;     // Product ID (little-endian)
@@ -326,24 +479,117 @@ public:
         bool operator !=(const USBConfig &other) const;
     };
 
+    // Command batch, which records control and bulk operations so that they can be executed back to back by executeBatch() (added in version 1.3.0)
+    // Only host-to-device operations can be recorded, and the data is copied, so that the batch can be executed any number of times
+    class Batch
+    {
+    private:
+        struct Operation {
+            uint8_t kind;               // Operation kind (control transfer, bulk transfer or delay)
+            uint8_t bmRequestType;      // Request type (only applicable to control transfers)
+            uint8_t bRequest;           // Request (only applicable to control transfers)
+            uint16_t wValue;            // Value (only applicable to control transfers)
+            uint16_t wIndex;            // Index (only applicable to control transfers)
+            uint8_t endpointAddr;       // Endpoint address (only applicable to bulk transfers)
+            unsigned int delay;         // Delay in microseconds (only applicable to delays)
+            std::vector<uint8_t> data;  // Data to be transferred
+        };
+
+        std::vector<Operation> operations_;
+
+        friend class CP2130;
+
+    public:
+        Batch();
+
+        bool empty() const;
+        size_t size() const;
+
+        void bulkWrite(uint8_t endpointOutAddr, const std::vector<uint8_t> &data);
+        void clear();
+        void configureSPIDelays(uint8_t channel, const SPIDelays &delays, int &errcnt, std::string &errstr);
+        void configureSPIMode(uint8_t channel, const SPIMode &mode, int &errcnt, std::string &errstr);
+        void controlWrite(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const std::vector<uint8_t> &data);
+        void delay(unsigned int microseconds);
+        void disableCS(uint8_t channel, int &errcnt, std::string &errstr);
+        void disableSPIDelays(uint8_t channel, int &errcnt, std::string &errstr);
+        void enableCS(uint8_t channel, int &errcnt, std::string &errstr);
+        void selectCS(uint8_t channel, int &errcnt, std::string &errstr);
+        void setGPIOs(uint16_t bmValues, uint16_t bmMask);
+        void spiWrite(const uint8_t *data, size_t size, uint8_t endpointOutAddr);
+        void spiWrite(const std::vector<uint8_t> &data, uint8_t endpointOutAddr);
+    };
+
+#ifdef CP2130_COROUTINES
+    // Awaitable that yields the result of an asynchronous transfer, as returned by the overloads of bulkTransferAsync(), controlReadAsync() and controlTransferAsync() that take no callback (added in version 1.3.0)
+    // The transfer is submitted before the awaitable is returned, and the awaiting coroutine is resumed from the thread that handles events once the transfer completes, or it is not suspended at all if that already happened
+    // Any other operation that takes a TransferCallback can be awaited as well, by passing callback() to it, as long as the callback is invoked even if the operation fails to be submitted
+    class TransferAwaitable
+    {
+    private:
+        struct State {
+            std::mutex mutex;
+            bool done;                       // True once the transfer completed
+            std::coroutine_handle<> handle;  // Coroutine awaiting the transfer, if any
+            TransferResult result;           // Result of the transfer ("data" is not applicable)
+        };
+
+        std::shared_ptr<State> state_;  // Shared with the callback, so that the awaitable can be moved, or even discarded, while the transfer is in flight
+
+    public:
+        TransferAwaitable();
+
+        bool await_ready() const;
+        TransferCallback callback() const;
+
+        TransferResult await_resume();
+        bool await_suspend(std::coroutine_handle<> handle);
+    };
+#endif
+
     CP2130();
     ~CP2130();
 
     bool disconnected() const;
     bool isOpen() const;
+    bool isStatsEnabled() const;
 
+    std::future<TransferResult> bulkReadAsync(uint8_t endpointInAddr, int length, int &errcnt, std::string &errstr);
+    Status bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred);
     void bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred, int &errcnt, std::string &errstr);
+    void bulkTransferAsync(uint8_t endpointAddr, unsigned char *data, int length, const TransferCallback &callback, int &errcnt, std::string &errstr);
+#ifdef CP2130_COROUTINES
+    TransferAwaitable bulkTransferAsync(uint8_t endpointAddr, unsigned char *data, int length, int &errcnt, std::string &errstr);
+#endif
+    std::future<TransferResult> bulkWriteAsync(uint8_t endpointOutAddr, const std::vector<uint8_t> &data, int &errcnt, std::string &errstr);
     void close();
     void configureGPIO(uint8_t pin, uint8_t mode, bool value, int &errcnt, std::string &errstr);
     void configureSPIDelays(uint8_t channel, const SPIDelays &delays, int &errcnt, std::string &errstr);
     void configureSPIMode(uint8_t channel, const SPIMode &mode, int &errcnt, std::string &errstr);
+    void controlReadAsync(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, const TransferCallback &callback, int &errcnt, std::string &errstr);
+#ifdef CP2130_COROUTINES
+    TransferAwaitable controlReadAsync(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr);
+#endif
+    Status controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength);
     void controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr);
+    void controlTransferAsync(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const unsigned char *data, uint16_t wLength, const TransferCallback &callback, int &errcnt, std::string &errstr);
+#ifdef CP2130_COROUTINES
+    TransferAwaitable controlTransferAsync(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const unsigned char *data, uint16_t wLength, int &errcnt, std::string &errstr);
+#endif
+    Status disableCS(uint8_t channel);
     void disableCS(uint8_t channel, int &errcnt, std::string &errstr);
     void disableSPIDelays(uint8_t channel, int &errcnt, std::string &errstr);
+    void disableStats();
+    Status enableCS(uint8_t channel);
     void enableCS(uint8_t channel, int &errcnt, std::string &errstr);
+    void enableStats();
+    void executeBatch(const Batch &batch, int &errcnt, std::string &errstr);
+    void executeBatch(const Batch &batch, std::vector<std::chrono::microseconds> &timestamps, int &errcnt, std::string &errstr);
     uint8_t getClockDivider(int &errcnt, std::string &errstr);
     bool getCS(uint8_t channel, int &errcnt, std::string &errstr);
+    Status getEndpointInAddr(uint8_t &endpointInAddr);
     uint8_t getEndpointInAddr(int &errcnt, std::string &errstr);
+    Status getEndpointOutAddr(uint8_t &endpointOutAddr);
     uint8_t getEndpointOutAddr(int &errcnt, std::string &errstr);
     EventCounter getEventCounter(int &errcnt, std::string &errstr);
     uint8_t getFIFOThreshold(int &errcnt, std::string &errstr);
@@ -361,21 +607,34 @@ public:
     uint16_t getGPIOs(int &errcnt, std::string &errstr);
     uint16_t getLockWord(int &errcnt, std::string &errstr);
     std::u16string getManufacturerDesc(int &errcnt, std::string &errstr);
+    void getManufacturerDesc(std::u16string &manufacturer, int &errcnt, std::string &errstr);
     PinConfig getPinConfig(int &errcnt, std::string &errstr);
     std::u16string getProductDesc(int &errcnt, std::string &errstr);
+    void getProductDesc(std::u16string &product, int &errcnt, std::string &errstr);
     PROMConfig getPROMConfig(int &errcnt, std::string &errstr);
     std::u16string getSerialDesc(int &errcnt, std::string &errstr);
+    void getSerialDesc(std::u16string &serial, int &errcnt, std::string &errstr);
     SiliconVersion getSiliconVersion(int &errcnt, std::string &errstr);
     SPIDelays getSPIDelays(uint8_t channel, int &errcnt, std::string &errstr);
     SPIMode getSPIMode(uint8_t channel, int &errcnt, std::string &errstr);
+    Stats getStats() const;
+    TransferPolicy getTransferPolicy(uint8_t transferClass, int &errcnt, std::string &errstr) const;
     uint8_t getTransferPriority(int &errcnt, std::string &errstr);
     USBConfig getUSBConfig(int &errcnt, std::string &errstr);
+    void invalidateCS();
+    void invalidatePROM();
     bool isOTPBlank(int &errcnt, std::string &errstr);
     bool isOTPLocked(int &errcnt, std::string &errstr);
     bool isRTRActive(int &errcnt, std::string &errstr);
     void lockOTP(int &errcnt, std::string &errstr);
     int open(uint16_t vid, uint16_t pid, const std::string &serial = std::string());
+    int open(libusb_context *context, uint16_t vid, uint16_t pid, const std::string &serial = std::string());
+    int open(const DeviceRecord &record);
+    int open(libusb_context *context, const DeviceRecord &record);
+    int open(USBTransport *transport);
     void reset(int &errcnt, std::string &errstr);
+    void resetStats();
+    Status selectCS(uint8_t channel);
     void selectCS(uint8_t channel, int &errcnt, std::string &errstr);
     void setClockDivider(uint8_t value, int &errcnt, std::string &errstr);
     void setEventCounter(const EventCounter &evcntr, int &errcnt, std::string &errstr);
@@ -391,11 +650,20 @@ public:
     void setGPIO8(bool value, int &errcnt, std::string &errstr);
     void setGPIO9(bool value, int &errcnt, std::string &errstr);
     void setGPIO10(bool value, int &errcnt, std::string &errstr);
+    Status setGPIOs(uint16_t bmValues, uint16_t bmMask);
     void setGPIOs(uint16_t bmValues, uint16_t bmMask, int &errcnt, std::string &errstr);
+    void setTransferPolicy(uint8_t transferClass, const TransferPolicy &policy, int &errcnt, std::string &errstr);
     std::vector<uint8_t> spiRead(uint32_t bytesToRead, uint8_t endpointInAddr, uint8_t endpointOutAddr, int &errcnt, std::string &errstr);
     std::vector<uint8_t> spiRead(uint32_t bytesToRead, int &errcnt, std::string &errstr);
+    Status spiRead(uint8_t *buffer, uint32_t bytesToRead, uint8_t endpointInAddr, uint8_t endpointOutAddr, uint32_t *bytesRead);
+    uint32_t spiRead(uint8_t *buffer, uint32_t bytesToRead, uint8_t endpointInAddr, uint8_t endpointOutAddr, int &errcnt, std::string &errstr);
+    Status spiWrite(const uint8_t *data, size_t size, uint8_t endpointOutAddr);
+    void spiWrite(const uint8_t *data, size_t size, uint8_t endpointOutAddr, int &errcnt, std::string &errstr);
     void spiWrite(const std::vector<uint8_t> &data, uint8_t endpointOutAddr, int &errcnt, std::string &errstr);
     void spiWrite(const std::vector<uint8_t> &data, int &errcnt, std::string &errstr);
+    void spiWriteAsync(const uint8_t *data, size_t size, uint8_t endpointOutAddr, const TransferCallback &callback, int &errcnt, std::string &errstr);
+    void spiWriteAsync(const std::vector<uint8_t> &data, uint8_t endpointOutAddr, const TransferCallback &callback, int &errcnt, std::string &errstr);
+    std::future<TransferResult> spiWriteAsync(const std::vector<uint8_t> &data, uint8_t endpointOutAddr, int &errcnt, std::string &errstr);
     std::vector<uint8_t> spiWriteRead(const std::vector<uint8_t> &data, uint8_t endpointInAddr, uint8_t endpointOutAddr, int &errcnt, std::string &errstr);
     std::vector<uint8_t> spiWriteRead(const std::vector<uint8_t> &data, int &errcnt, std::string &errstr);
     void stopRTR(int &errcnt, std::string &errstr);
@@ -407,7 +675,11 @@ public:
     void writeSerialDesc(const std::u16string &serial, int &errcnt, std::string &errstr);
     void writeUSBConfig(const USBConfig &config, uint8_t mask, int &errcnt, std::string &errstr);
 
+    static std::vector<DeviceRecord> enumerateDevices(uint16_t vid, uint16_t pid, int &errcnt, std::string &errstr);
+    static std::vector<DeviceRecord> enumerateDevices(libusb_context *context, uint16_t vid, uint16_t pid, int &errcnt, std::string &errstr);
+    static void enumerateDevices(libusb_context *context, uint16_t vid, uint16_t pid, std::vector<DeviceRecord> &devices, int &errcnt, std::string &errstr);
     static std::list<std::string> listDevices(uint16_t vid, uint16_t pid, int &errcnt, std::string &errstr);
+    static void listDevices(uint16_t vid, uint16_t pid, std::vector<std::string> &devices, int &errcnt, std::string &errstr);
 };
 
 #endif  // CP2130_H
@@ -0,0 +1,253 @@
+/* CP2130 ReadWithRTR streaming reader class - Version 1.0.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <algorithm>
+#include "cp2130rtrreader.h"
+
+// Definitions
+const size_t RTR_PACKETSIZE = 64;  // Maximum packet size of the bulk endpoints, to which the region size is rounded up, so that only the last transfer of a command can be short
+const size_t RTR_MINREGIONS = 2;   // Minimum number of regions, so that one can be filled while the other is handed to the callback
+
+// Private procedure used to account for a completed transfer into the given region, which is then queued again
+// A transfer that times out only means that the slave kept RTR inactive for too long, so the bytes that were not received are requested again
+// A short transfer marks the end of the command, and the first failure ends the stream
+void CP2130RTRReader::complete(size_t index, uint32_t length, int status, int transferred)
+{
+    if (transferred > 0) {
+        bytesRead_ += static_cast<uint64_t>(transferred);
+        callback_(&buffer_[regionSize_ * index], static_cast<size_t>(transferred));
+    }
+    {
+        std::lock_guard<std::mutex> lock(submitMutex_);
+        if (status == LIBUSB_TRANSFER_TIMED_OUT && !ended_) {
+            outstanding_ += length - static_cast<uint32_t>(transferred);
+        } else if (status != LIBUSB_TRANSFER_COMPLETED) {
+            if (!ended_) {
+                status_ = status;  // Failures caused by stop() are not reported
+            }
+            ended_ = true;
+        } else if (static_cast<uint32_t>(transferred) < length) {
+            ended_ = true;
+        }
+        queue_.push_back(index);
+    }
+    drain();
+}
+
+// Private procedure that submits a transfer for each region waiting in the queue, or frees the region if the stream has ended
+// Only one thread drains the queue at a time, and regions queued meanwhile are picked up by that thread, so that transports other than libusb, which complete transfers inline, do not cause recursion
+void CP2130RTRReader::drain()
+{
+    std::unique_lock<std::mutex> lock(submitMutex_);
+    if (!draining_) {
+        draining_ = true;
+        while (!queue_.empty()) {
+            size_t index = queue_.front();
+            queue_.pop_front();
+            if (ended_ || outstanding_ == 0) {
+                release(index);
+            } else {
+                uint32_t length = static_cast<uint32_t>(std::min(static_cast<size_t>(outstanding_), regionSize_));
+                outstanding_ -= length;
+                lock.unlock();
+                int errcnt = 0;
+                std::string errstr;
+                cp2130_.bulkTransferAsync(endpointInAddr_, &buffer_[regionSize_ * index], static_cast<int>(length), [this, index, length](int status, int transferred) {
+                    complete(index, length, status, transferred);
+                }, errcnt, errstr);
+                lock.lock();
+                if (errcnt != 0) {  // The callback is not invoked if the transfer could not be submitted
+                    if (!ended_) {
+                        status_ = LIBUSB_TRANSFER_ERROR;
+                    }
+                    ended_ = true;
+                    release(index);
+                }
+            }
+        }
+        draining_ = false;
+    }
+}
+
+// Private function that checks if no transfers are in flight
+bool CP2130RTRReader::isIdle() const
+{
+    bool idle = true;
+    for (size_t i = 0; i < regions_.size(); ++i) {
+        if (regions_[i].busy) {
+            idle = false;
+            break;
+        }
+    }
+    return idle;
+}
+
+// Private procedure that frees the given region
+void CP2130RTRReader::release(size_t index)
+{
+    std::lock_guard<std::mutex> lock(waitMutex_);  // The region is freed under the mutex, so that stop() cannot return, and the reader cannot be destroyed, before the notification
+    regions_[index].busy = false;
+    waitCondition_.notify_all();
+}
+
+// The region size is rounded up to a multiple of the maximum packet size, and at least two regions are used
+CP2130RTRReader::CP2130RTRReader(CP2130 &cp2130, size_t regionSize, size_t regions) :
+    cp2130_(cp2130),
+    regionSize_(std::max((regionSize + RTR_PACKETSIZE - 1) / RTR_PACKETSIZE, static_cast<size_t>(1)) * RTR_PACKETSIZE),
+    buffer_(),
+    regions_(std::max(regions, RTR_MINREGIONS)),
+    callback_(),
+    endpointInAddr_(0),
+    outstanding_(0),
+    ended_(true),
+    draining_(false),
+    queue_(),
+    submitMutex_(),
+    bytesRead_(0),
+    status_(LIBUSB_TRANSFER_COMPLETED),
+    running_(false),
+    waitMutex_(),
+    waitCondition_()
+{
+    buffer_.resize(regionSize_ * regions_.size());
+    for (size_t i = 0; i < regions_.size(); ++i) {
+        regions_[i].busy = false;
+    }
+}
+
+CP2130RTRReader::~CP2130RTRReader()
+{
+    int errcnt = 0;
+    std::string errstr;
+    stop(errcnt, errstr);  // Any transfers still in flight must complete before the ring buffer is destroyed
+}
+
+// Returns the number of bytes read since the stream was started
+uint64_t CP2130RTRReader::bytesRead() const
+{
+    return bytesRead_;
+}
+
+// Checks if the reader is running, that is, if start() was called and stop() was not called since
+bool CP2130RTRReader::isRunning() const
+{
+    return running_;
+}
+
+// Checks if any transfers are in flight, which is no longer the case once every requested byte was read, or once the stream ended or failed
+bool CP2130RTRReader::isStreaming() const
+{
+    return !isIdle();
+}
+
+// Returns the size of each region of the ring buffer, in bytes
+size_t CP2130RTRReader::regionSize() const
+{
+    return regionSize_;
+}
+
+// Returns the number of regions of the ring buffer, which is also the maximum number of transfers kept queued
+size_t CP2130RTRReader::regions() const
+{
+    return regions_.size();
+}
+
+// Returns LIBUSB_TRANSFER_COMPLETED if every transfer succeeded so far, or the status of the first one that failed
+int CP2130RTRReader::status() const
+{
+    return status_;
+}
+
+// Sets the FIFO threshold to the given value (see CP2130::setFIFOThreshold()), and then issues a ReadWithRTR command for the given number of bytes, queueing a transfer into each region
+// The callback is invoked from the event handling thread of the CP2130, or from the thread that owns the libusb context, if shared, and must not call stop()
+// With a transport other than libusb, transfers complete synchronously, and so this function only returns after the stream ends
+void CP2130RTRReader::start(uint32_t bytesToRead, uint8_t threshold, const DataCallback &callback, int &errcnt, std::string &errstr)
+{
+    if (running_) {
+        ++errcnt;
+        errstr += "In start(): Reader is already running.\n";  // Program logic error
+    } else if (!cp2130_.isOpen()) {
+        ++errcnt;
+        errstr += "In start(): device is not open.\n";  // Program logic error
+    } else if (bytesToRead == 0) {
+        ++errcnt;
+        errstr += "In start(): Number of bytes to read must be greater than zero.\n";  // Program logic error
+    } else if (!callback) {
+        ++errcnt;
+        errstr += "In start(): Callback is empty.\n";  // Program logic error
+    } else {
+        int initerrcnt = errcnt;
+        endpointInAddr_ = cp2130_.getEndpointInAddr(errcnt, errstr);
+        uint8_t endpointOutAddr = cp2130_.getEndpointOutAddr(errcnt, errstr);
+        cp2130_.setFIFOThreshold(threshold, errcnt, errstr);
+        if (errcnt == initerrcnt) {
+            unsigned char readWithRTRCommandBuffer[8] = {
+                0x00, 0x00,           // Reserved
+                CP2130::READWITHRTR,  // ReadWithRTR command
+                0x00,                 // Reserved
+                static_cast<uint8_t>(bytesToRead),
+                static_cast<uint8_t>(bytesToRead >> 8),
+                static_cast<uint8_t>(bytesToRead >> 16),
+                static_cast<uint8_t>(bytesToRead >> 24)
+            };
+#if LIBUSB_API_VERSION >= 0x01000105
+            cp2130_.bulkTransfer(endpointOutAddr, readWithRTRCommandBuffer, static_cast<int>(sizeof(readWithRTRCommandBuffer)), nullptr, errcnt, errstr);
+#else
+            int bytesWritten;
+            cp2130_.bulkTransfer(endpointOutAddr, readWithRTRCommandBuffer, static_cast<int>(sizeof(readWithRTRCommandBuffer)), &bytesWritten, errcnt, errstr);
+#endif
+        }
+        if (errcnt == initerrcnt) {
+            callback_ = callback;
+            bytesRead_ = 0;
+            status_ = LIBUSB_TRANSFER_COMPLETED;
+            running_ = true;
+            {
+                std::lock_guard<std::mutex> lock(submitMutex_);
+                outstanding_ = bytesToRead;
+                ended_ = false;
+                for (size_t i = 0; i < regions_.size(); ++i) {
+                    regions_[i].busy = true;
+                    queue_.push_back(i);
+                }
+            }
+            drain();
+        }
+    }
+}
+
+// Stops the stream, aborting the ReadWithRTR command if any transfers are still in flight, and then waiting for them to complete
+void CP2130RTRReader::stop(int &errcnt, std::string &errstr)
+{
+    if (running_) {
+        {
+            std::lock_guard<std::mutex> lock(submitMutex_);
+            ended_ = true;
+        }
+        if (!isIdle()) {
+            cp2130_.stopRTR(errcnt, errstr);
+        }
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        waitCondition_.wait(lock, [this] { return isIdle(); });  // Transfers complete within the transfer timeout, even if the device is disconnected
+        running_ = false;
+    }
+}
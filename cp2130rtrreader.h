@@ -0,0 +1,88 @@
+/* CP2130 ReadWithRTR streaming reader class - Version 1.0.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef CP2130RTRREADER_H
+#define CP2130RTRREADER_H
+
+// Includes
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cp2130.h"
+
+// Streaming reader that issues a single ReadWithRTR command and keeps several bulk IN transfers queued into the regions of a preallocated ring buffer
+// Each filled region is handed to the data callback in place, and the region is queued again as soon as the callback returns
+// If the callback falls behind, fewer transfers stay queued and the FIFO of the CP2130 fills up, at which point the threshold given to start() comes into play
+// GPIO.3 must be configured as RTR or !RTR input, and GPIO.4 as FIFO full output if the slave is to be throttled, as per the OTP ROM (see CP2130::getPinConfig())
+// While streaming, the CP2130 can still be used from another thread for control transfers, but it must not be closed or reopened
+class CP2130RTRReader
+{
+private:
+    struct Region {
+        std::atomic<bool> busy;  // True while a transfer into the region is queued, or while its data is handed to the callback
+    };
+
+    CP2130 &cp2130_;
+    size_t regionSize_;
+    std::vector<uint8_t> buffer_;
+    std::vector<Region> regions_;
+    std::function<void(const uint8_t *, size_t)> callback_;  // See DataCallback
+    uint8_t endpointInAddr_;
+    uint32_t outstanding_;      // Number of bytes yet to be requested by a transfer
+    bool ended_, draining_;
+    std::deque<size_t> queue_;  // Regions waiting to be submitted (see drain())
+    std::mutex submitMutex_;
+    std::atomic<uint64_t> bytesRead_;
+    std::atomic<int> status_;
+    std::atomic<bool> running_;
+    std::mutex waitMutex_;
+    std::condition_variable waitCondition_;
+
+    void complete(size_t index, uint32_t length, int status, int transferred);
+    void drain();
+    bool isIdle() const;
+    void release(size_t index);
+
+public:
+    // Callback that receives the data read into a region of the ring buffer, which is only valid until the callback returns
+    typedef std::function<void(const uint8_t *data, size_t length)> DataCallback;
+
+    explicit CP2130RTRReader(CP2130 &cp2130, size_t regionSize = 4096, size_t regions = 4);
+    ~CP2130RTRReader();
+
+    uint64_t bytesRead() const;
+    bool isRunning() const;
+    bool isStreaming() const;
+    size_t regionSize() const;
+    size_t regions() const;
+    int status() const;
+
+    void start(uint32_t bytesToRead, uint8_t threshold, const DataCallback &callback, int &errcnt, std::string &errstr);
+    void stop(int &errcnt, std::string &errstr);
+};
+
+#endif  // CP2130RTRREADER_H
@@ -0,0 +1,301 @@
+/* CP2130 sampler class - Version 1.0.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include "cp2130sampler.h"
+
+// Definitions
+const size_t SMP_DEPTH = 4;        // Maximum number of samples in flight, each consisting of up to two queued control transfers
+const size_t SMP_MINCAPACITY = 2;  // Minimum capacity of the ring buffer
+
+// Private procedure used to account for a completed transfer belonging to the given slot, which is called once per transfer, and once more after submitting them
+// The first failure is kept, and a short data stage is reported as an error
+void CP2130Sampler::complete(Slot &slot, int status, int transferred, int expected)
+{
+    if (status != LIBUSB_TRANSFER_COMPLETED || transferred != expected) {
+        int completed = LIBUSB_TRANSFER_COMPLETED;
+        slot.status.compare_exchange_strong(completed, status != LIBUSB_TRANSFER_COMPLETED ? status : LIBUSB_TRANSFER_ERROR);
+    }
+    if (slot.pending.fetch_sub(1) == 1) {  // Last transfer of the sample
+        finish(slot);
+    }
+}
+
+// Private procedure that stores the sample gathered by the given slot in the ring buffer, and then frees the slot
+// If the ring buffer is full, the sample is discarded and accounted for as an overrun, so that the consumer never has to wait for the producer
+void CP2130Sampler::finish(Slot &slot)
+{
+    slot.record.completed = std::chrono::steady_clock::now();
+    slot.record.status = slot.status.load();
+    {
+        std::lock_guard<std::mutex> lock(produceMutex_);  // Samples are normally finished by the event handling thread alone, but a failed submission is finished by the sampling thread
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= ring_.size()) {
+            ++overruns_;
+        } else {
+            ring_[mask_ & head] = slot.record;
+            head_.store(head + 1, std::memory_order_release);
+        }
+    }
+    std::lock_guard<std::mutex> lock(waitMutex_);  // The slot is freed under the mutex, so that stop() cannot return, and the sampler cannot be destroyed, before the notification
+    slot.busy = false;
+    waitCondition_.notify_all();
+}
+
+// Private function that checks if no samples are in flight
+bool CP2130Sampler::isIdle() const
+{
+    bool idle = true;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].busy) {
+            idle = false;
+            break;
+        }
+    }
+    return idle;
+}
+
+// Private procedure that requests a new sample, by submitting the corresponding control transfers
+// If the oldest slot is still in flight, the device is not keeping up with the sampling rate, and the sample is accounted for as missed
+// This is called by start() for the first sample, and then by the sampling thread alone, never by both at once (see start()), which is why nextSlot_, sequence_ and the slot records need no locking here
+void CP2130Sampler::request()
+{
+    uint64_t sequence = sequence_++;
+    Slot &slot = slots_[nextSlot_];
+    if (slot.busy) {
+        ++missed_;
+    } else {
+        nextSlot_ = (nextSlot_ + 1) % SMP_DEPTH;
+        slot.busy = true;
+        slot.record.sequence = sequence;
+        slot.record.requested = std::chrono::steady_clock::now();
+        std::memset(slot.record.counter, 0x00, sizeof(slot.record.counter));  // Sources that are not sampled are reported as zero
+        std::memset(slot.record.gpios, 0x00, sizeof(slot.record.gpios));
+        slot.status = LIBUSB_TRANSFER_COMPLETED;
+        slot.pending = ((SOURCE_EVENTCOUNTER & sources_) != 0 ? 1 : 0) + ((SOURCE_GPIOS & sources_) != 0 ? 1 : 0) + 1;  // The extra count keeps the slot from being finished while the transfers are submitted
+        if ((SOURCE_EVENTCOUNTER & sources_) != 0) {
+            int errcnt = 0;
+            std::string errstr;
+            cp2130_.controlReadAsync(CP2130::GET_EVENT_COUNTER, 0x0000, 0x0000, slot.record.counter, CP2130::GET_EVENT_COUNTER_WLEN, [this, &slot](int status, int transferred) {
+                complete(slot, status, transferred, CP2130::GET_EVENT_COUNTER_WLEN);
+            }, errcnt, errstr);
+            if (errcnt != 0) {  // The callback is not invoked if the transfer could not be submitted
+                complete(slot, LIBUSB_TRANSFER_ERROR, 0, CP2130::GET_EVENT_COUNTER_WLEN);
+            }
+        }
+        if ((SOURCE_GPIOS & sources_) != 0) {
+            int errcnt = 0;
+            std::string errstr;
+            cp2130_.controlReadAsync(CP2130::GET_GPIO_VALUES, 0x0000, 0x0000, slot.record.gpios, CP2130::GET_GPIO_VALUES_WLEN, [this, &slot](int status, int transferred) {
+                complete(slot, status, transferred, CP2130::GET_GPIO_VALUES_WLEN);
+            }, errcnt, errstr);
+            if (errcnt != 0) {
+                complete(slot, LIBUSB_TRANSFER_ERROR, 0, CP2130::GET_GPIO_VALUES_WLEN);
+            }
+        }
+        complete(slot, LIBUSB_TRANSFER_COMPLETED, 0, 0);  // Releases the extra count
+    }
+}
+
+// Private procedure that implements the sampling thread, which requests a sample at the given time and then once every period
+// Sampling periods that have already passed when the thread wakes up are skipped and accounted for as missed, instead of being requested in a burst
+void CP2130Sampler::run(std::chrono::steady_clock::time_point next)
+{
+    std::unique_lock<std::mutex> lock(waitMutex_);
+    while (!waitCondition_.wait_until(lock, next, [this] { return stop_.load(); })) {
+        lock.unlock();
+        request();
+        next += period_;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (next < now) {
+            std::chrono::microseconds::rep skipped = std::chrono::duration_cast<std::chrono::microseconds>(now - next) / period_;
+            next += skipped * period_;
+            missed_ += static_cast<uint64_t>(skipped);
+            sequence_ += static_cast<uint64_t>(skipped);
+        }
+        lock.lock();
+    }
+}
+
+// "Equal to" operator for Sample
+bool CP2130Sampler::Sample::operator ==(const CP2130Sampler::Sample &other) const
+{
+    return sequence == other.sequence && timestamp == other.timestamp && latency == other.latency && status == other.status && evcntr == other.evcntr && gpios == other.gpios;
+}
+
+// "Not equal to" operator for Sample
+bool CP2130Sampler::Sample::operator !=(const CP2130Sampler::Sample &other) const
+{
+    return !(operator ==(other));
+}
+
+// The capacity of the ring buffer is rounded up to the next power of two
+CP2130Sampler::CP2130Sampler(CP2130 &cp2130, size_t capacity) :
+    cp2130_(cp2130),
+    sources_(0),
+    period_(0),
+    sequence_(0),
+    slots_(SMP_DEPTH),
+    nextSlot_(0),
+    ring_(),
+    mask_(0),
+    head_(0),
+    tail_(0),
+    produceMutex_(),
+    missed_(0),
+    overruns_(0),
+    running_(false),
+    stop_(false),
+    thread_(),
+    waitMutex_(),
+    waitCondition_()
+{
+    size_t size = SMP_MINCAPACITY;
+    while (size < capacity) {
+        size *= 2;
+    }
+    ring_.resize(size);
+    mask_ = size - 1;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        slots_[i].status = LIBUSB_TRANSFER_COMPLETED;
+        slots_[i].pending = 0;
+        slots_[i].busy = false;
+    }
+}
+
+CP2130Sampler::~CP2130Sampler()
+{
+    stop();  // Any samples still in flight must complete before the slots are destroyed
+}
+
+// Returns the number of samples that are available to be read
+size_t CP2130Sampler::available() const
+{
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+}
+
+// Returns the capacity of the ring buffer
+size_t CP2130Sampler::capacity() const
+{
+    return ring_.size();
+}
+
+// Checks if the sampler is running
+bool CP2130Sampler::isRunning() const
+{
+    return running_;
+}
+
+// Returns the number of samples that were missed since the sampler was started, either because the device did not keep up or because the sampling thread was delayed
+uint64_t CP2130Sampler::missedSamples() const
+{
+    return missed_;
+}
+
+// Returns the number of samples that were discarded since the sampler was started, because the ring buffer was full
+uint64_t CP2130Sampler::overruns() const
+{
+    return overruns_;
+}
+
+// Reads the oldest available sample into "sample", returning false if there are none
+// This never blocks, and no USB I/O takes place
+bool CP2130Sampler::read(Sample &sample)
+{
+    bool retval;
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+        retval = false;
+    } else {
+        const Record &record = ring_[mask_ & tail];
+        sample.sequence = record.sequence;
+        sample.timestamp = record.requested;
+        sample.latency = std::chrono::duration_cast<std::chrono::microseconds>(record.completed - record.requested);
+        sample.status = record.status;
+        sample.evcntr.overflow = (0x80 & record.counter[0]) != 0x00;                         // As in CP2130::getEventCounter()
+        sample.evcntr.mode = static_cast<uint8_t>(0x07 & record.counter[0]);
+        sample.evcntr.value = static_cast<uint16_t>(record.counter[1] << 8 | record.counter[2]);
+        sample.gpios = static_cast<uint16_t>(CP2130::BMGPIOS & (record.gpios[0] << 8 | record.gpios[1]));  // As in CP2130::getGPIOs()
+        tail_.store(tail + 1, std::memory_order_release);
+        retval = true;
+    }
+    return retval;
+}
+
+// Appends up to "max" of the oldest available samples to the given vector, returning the number of samples read
+size_t CP2130Sampler::read(std::vector<Sample> &samples, size_t max)
+{
+    size_t count = 0;
+    Sample sample;
+    while (count < max && read(sample)) {
+        samples.push_back(sample);
+        ++count;
+    }
+    return count;
+}
+
+// Starts sampling the given sources, which must be a combination of SOURCE_EVENTCOUNTER and SOURCE_GPIOS, once every period
+// The first sample is requested right away, from the calling thread, and any samples that were not read are kept
+void CP2130Sampler::start(uint8_t sources, std::chrono::microseconds period, int &errcnt, std::string &errstr)
+{
+    if (running_) {
+        ++errcnt;
+        errstr += "In start(): Sampler is already running.\n";  // Program logic error
+    } else if (!cp2130_.isOpen()) {
+        ++errcnt;
+        errstr += "In start(): device is not open.\n";  // Program logic error
+    } else if (sources == 0 || (~(SOURCE_EVENTCOUNTER | SOURCE_GPIOS) & sources) != 0) {
+        ++errcnt;
+        errstr += "In start(): Sources must be a combination of SOURCE_EVENTCOUNTER and SOURCE_GPIOS.\n";  // Program logic error
+    } else if (period.count() <= 0) {
+        ++errcnt;
+        errstr += "In start(): Period must be greater than zero.\n";  // Program logic error
+    } else {
+        sources_ = sources;
+        period_ = period;
+        sequence_ = 0;
+        missed_ = 0;
+        overruns_ = 0;
+        stop_ = false;
+        running_ = true;
+        std::chrono::steady_clock::time_point first = std::chrono::steady_clock::now();
+        request();  // This also starts the event handling thread of the CP2130, if required, before the sampling thread exists
+        thread_ = std::thread(&CP2130Sampler::run, this, first + period);  // Creating the thread synchronizes with its start, so that it sees the plain fields (e.g. nextSlot_ and sequence_) as left by the above call, and it is the only caller of request() from here on
+    }
+}
+
+// Stops sampling, waiting for any samples in flight to complete
+// The samples that were not read are kept
+void CP2130Sampler::stop()
+{
+    if (running_) {
+        {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            stop_ = true;
+        }
+        waitCondition_.notify_all();
+        thread_.join();
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        waitCondition_.wait(lock, [this] { return isIdle(); });  // Samples are finished within the transfer timeout, even if the device is disconnected
+        running_ = false;
+    }
+}
@@ -0,0 +1,114 @@
+/* CP2130 sampler class - Version 1.0.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef CP2130SAMPLER_H
+#define CP2130SAMPLER_H
+
+// Includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cp2130.h"
+
+// Background sampler that polls the event counter and/or the GPIO values of a CP2130 at a fixed rate, using queued asynchronous control transfers
+// Samples are timestamped and stored in a lock-free ring buffer, so that a consumer thread can read them without doing any USB I/O itself
+// The ring buffer has a single consumer, so read() must not be called from more than one thread at a time
+// While sampling, the CP2130 can still be used from another thread for other transfers, but it must not be closed or reopened
+class CP2130Sampler
+{
+private:
+    struct Record {
+        uint64_t sequence;                                            // Sequence number (see Sample)
+        std::chrono::steady_clock::time_point requested, completed;  // Times at which the sample was requested and completed
+        int status;                                                   // Combined status of the transfers (see Sample)
+        unsigned char counter[CP2130::GET_EVENT_COUNTER_WLEN];        // Data stage of the "Get_Event_Counter" request
+        unsigned char gpios[CP2130::GET_GPIO_VALUES_WLEN];            // Data stage of the "Get_GPIO_Values" request
+    };
+
+    struct Slot {
+        Record record;             // Sample being gathered
+        std::atomic<int> status;   // Combined status of the transfers completed so far
+        std::atomic<int> pending;  // Number of transfers yet to complete, plus one while they are being submitted
+        std::atomic<bool> busy;    // True until the sample is stored in the ring buffer
+    };
+
+    CP2130 &cp2130_;
+    uint8_t sources_;
+    std::chrono::microseconds period_;
+    uint64_t sequence_;
+    std::vector<Slot> slots_;
+    size_t nextSlot_;
+    std::vector<Record> ring_;
+    size_t mask_;
+    std::atomic<size_t> head_, tail_;
+    std::mutex produceMutex_;
+    std::atomic<uint64_t> missed_, overruns_;
+    std::atomic<bool> running_, stop_;
+    std::thread thread_;
+    std::mutex waitMutex_;
+    std::condition_variable waitCondition_;
+
+    void complete(Slot &slot, int status, int transferred, int expected);
+    void finish(Slot &slot);
+    bool isIdle() const;
+    void request();
+    void run(std::chrono::steady_clock::time_point next);
+
+public:
+    // Sources applicable to start()
+    static const uint8_t SOURCE_EVENTCOUNTER = 0x01;  // Event counter, as returned by CP2130::getEventCounter()
+    static const uint8_t SOURCE_GPIOS = 0x02;         // GPIO values, as returned by CP2130::getGPIOs()
+
+    // Sample, as returned by read()
+    struct Sample {
+        uint64_t sequence;                                // Sequence number, which is incremented for every sampling period, so that missed samples show up as gaps
+        std::chrono::steady_clock::time_point timestamp;  // Time at which the sample was requested
+        std::chrono::microseconds latency;                // Time taken to complete the sample
+        int status;                                       // LIBUSB_TRANSFER_COMPLETED if every transfer succeeded, or the status of the first one that failed
+        CP2130::EventCounter evcntr;                      // Event counter (only applicable if sampled)
+        uint16_t gpios;                                   // GPIO values, in bitmap format (only applicable if sampled)
+
+        bool operator ==(const Sample &other) const;
+        bool operator !=(const Sample &other) const;
+    };
+
+    explicit CP2130Sampler(CP2130 &cp2130, size_t capacity = 4096);
+    ~CP2130Sampler();
+
+    size_t available() const;
+    size_t capacity() const;
+    bool isRunning() const;
+    uint64_t missedSamples() const;
+    uint64_t overruns() const;
+
+    bool read(Sample &sample);
+    size_t read(std::vector<Sample> &samples, size_t max);
+    void start(uint8_t sources, std::chrono::microseconds period, int &errcnt, std::string &errstr);
+    void stop();
+};
+
+#endif  // CP2130SAMPLER_H
@@ -0,0 +1,792 @@
+/* CP2130 simulator class - Version 1.0.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <algorithm>
+#include "cp2130simulator.h"
+
+// Definitions
+const uint8_t SIM_VERSION_MAJ = 0x01;        // Simulated major read-only version
+const uint8_t SIM_VERSION_MIN = 0x00;        // Simulated minor read-only version
+const uint8_t SIM_FIFOTHRESHOLD = 0x80;      // FIFO threshold after power-on or reset
+const uint8_t SIM_SPIDELAYS_CSTGLEN = 0x08;  // Mask for the CS toggle enable bit, as found on byte 1 of the SPI delays
+const uint8_t SIM_SPIWORD_CPOL = 0x10;       // Mask for the CPOL bit of the SPI word
+const uint8_t SIM_SPIWORD_CPHA = 0x20;       // Mask for the CPHA bit of the SPI word
+const size_t SIM_TBLSIZE = 64;               // Size of the tables returned by the string requests
+
+// Default configuration of a blank CP2130
+const CP2130::USBConfig SIM_DEFAULTCONFIG = {
+    CP2130::VID,         // Vendor ID
+    CP2130::PID,         // Product ID
+    0x01,                // Major release version
+    0x00,                // Minor release version
+    0x32,                // Maximum consumption current (100mA)
+    CP2130::PMBUSREGEN,  // Power mode
+    CP2130::PRIOWRITE    // Transfer priority
+};
+
+// LTC2640 commands, as given by the four most significant bits of each 24-bit word
+const uint8_t LTC_WRITE = 0x0;        // Write to input register
+const uint8_t LTC_UPDATE = 0x1;       // Update (power up) DAC register
+const uint8_t LTC_WRITEUPDATE = 0x3;  // Write to and update (power up) DAC register
+const uint8_t LTC_POWERDOWN = 0x4;    // Power down
+const uint8_t LTC_INTREF = 0x6;       // Select internal reference
+const uint8_t LTC_EXTREF = 0x7;       // Select external reference
+
+// Private procedure that clocks one byte out of MOSI, returning the byte clocked into MISO
+// The byte reaches the LTC2640 only while the chip select of channel 0 is enabled, and, if CS toggle is enabled, each byte is delimited as a separate frame
+uint8_t CP2130Simulator::clockByte(uint8_t mosi)
+{
+    if ((0x0001 & csEnabled_) != 0x0000) {
+        frame_.push_back(mosi);
+        if ((SIM_SPIDELAYS_CSTGLEN & spiDelays_[0][1]) != 0x00) {
+            endFrame();
+        }
+    }
+    return loopback_ ? mosi : 0x00;  // The LTC2640 has no data output, so MISO reads as zero unless the loopback is enabled
+}
+
+// Private procedure that delivers the current frame to the LTC2640, once the chip select is deasserted
+// As with the LTC2640, a frame shorter than 24 bits is discarded, and only the last 24 bits are decoded when the frame is longer than that
+void CP2130Simulator::endFrame()
+{
+    if (!frame_.empty()) {
+        ++dacFrames_;
+        bool cpol = (SIM_SPIWORD_CPOL & spiWords_[0]) != 0x00;
+        bool cpha = (SIM_SPIWORD_CPHA & spiWords_[0]) != 0x00;
+        size_t size = frame_.size();
+        if (size < 3 || cpol != cpha) {  // The LTC2640 samples data on rising edges, which only happens in SPI modes 0 and 3
+            ++dacFrameErrors_;
+        } else {
+            uint8_t command = static_cast<uint8_t>(frame_[size - 3] >> 4);
+            uint16_t code = static_cast<uint16_t>(frame_[size - 2] << 4 | frame_[size - 1] >> 4);
+            switch (command) {
+                case LTC_WRITE:
+                    dacInput_ = code;
+                    break;
+                case LTC_UPDATE:
+                    dacCode_ = dacInput_;
+                    dacPoweredDown_ = false;
+                    ++dacUpdates_;
+                    break;
+                case LTC_WRITEUPDATE:
+                    dacInput_ = code;
+                    dacCode_ = code;
+                    dacPoweredDown_ = false;
+                    ++dacUpdates_;
+                    break;
+                case LTC_POWERDOWN:
+                    dacPoweredDown_ = true;
+                    break;
+                case LTC_INTREF:
+                    dacExternalRef_ = false;
+                    break;
+                case LTC_EXTREF:
+                    dacExternalRef_ = true;
+                    break;
+                default:  // No operation
+                    break;
+            }
+        }
+        frame_.clear();
+    }
+}
+
+// Private function that returns the data waiting to be read from the bulk IN endpoint
+int CP2130Simulator::handleBulkIn(unsigned char *data, int length, int *transferred)
+{
+    int result;
+    if (inQueue_.empty()) {
+        result = LIBUSB_ERROR_TIMEOUT;  // Nothing was commanded to be read, so the transfer times out, as it does on the CP2130
+    } else {
+        size_t size = std::min(static_cast<size_t>(length), inQueue_.size());
+        std::copy(inQueue_.begin(), inQueue_.begin() + size, data);
+        inQueue_.erase(inQueue_.begin(), inQueue_.begin() + size);
+        if (transferred != nullptr) {
+            *transferred = static_cast<int>(size);
+        }
+        result = LIBUSB_SUCCESS;
+    }
+    return result;
+}
+
+// Private function that parses the data sent to the bulk OUT endpoint as a stream of SPI commands, each made of an 8-byte header optionally followed by data
+// Commands can span any number of transfers, and an unknown command causes the endpoint to stall
+int CP2130Simulator::handleBulkOut(const unsigned char *data, int length, int *transferred)
+{
+    int result = LIBUSB_SUCCESS;
+    int bytesProcessed = 0;
+    while (result == LIBUSB_SUCCESS && bytesProcessed < length) {
+        uint8_t byte = data[bytesProcessed];
+        if (headerBytes_ < sizeof(header_)) {
+            header_[headerBytes_] = byte;
+            ++headerBytes_;
+            if (headerBytes_ == sizeof(header_)) {
+                command_ = header_[2];
+                bytesRemaining_ = static_cast<uint32_t>(header_[7]) << 24 | static_cast<uint32_t>(header_[6] << 16 | header_[5] << 8 | header_[4]);  // Little-endian conversion
+                if (command_ == CP2130::READ || command_ == CP2130::READWITHRTR) {  // Note that RTR is always assumed to be active, so both commands behave alike
+                    for (uint32_t i = 0; i < bytesRemaining_; ++i) {
+                        inQueue_.push_back(clockByte(0x00));
+                    }
+                    endFrame();
+                    headerBytes_ = 0;
+                } else if (command_ == CP2130::WRITE || command_ == CP2130::WRITEREAD) {
+                    if (bytesRemaining_ == 0) {
+                        headerBytes_ = 0;
+                    }
+                } else {
+                    headerBytes_ = 0;
+                    result = LIBUSB_ERROR_PIPE;  // Unknown command
+                }
+            }
+        } else {
+            uint8_t miso = clockByte(byte);
+            if (command_ == CP2130::WRITEREAD) {
+                inQueue_.push_back(miso);
+            }
+            --bytesRemaining_;
+            if (bytesRemaining_ == 0) {
+                endFrame();
+                headerBytes_ = 0;
+            }
+        }
+        ++bytesProcessed;
+    }
+    if (transferred != nullptr) {
+        *transferred = result == LIBUSB_SUCCESS ? bytesProcessed : bytesProcessed - 1;  // The byte that caused the stall is not accounted for
+    }
+    return result;
+}
+
+// Private function that handles device-to-host vendor requests, returning the number of bytes transferred, or LIBUSB_ERROR_PIPE if the request is not valid
+int CP2130Simulator::handleGet(uint8_t bRequest, uint16_t wIndex, unsigned char *data, uint16_t wLength)
+{
+    uint8_t response[SIM_TBLSIZE] = {0x00};
+    size_t size = 0;
+    size_t index = 0, fieldSize = 0;  // Applicable to requests that return an OTP ROM field
+    bool valid = true;
+    switch (bRequest) {
+        case CP2130::GET_READONLY_VERSION:
+            response[0] = SIM_VERSION_MAJ;
+            response[1] = SIM_VERSION_MIN;
+            size = CP2130::GET_READONLY_VERSION_WLEN;
+            break;
+        case CP2130::GET_GPIO_VALUES:
+            response[0] = static_cast<uint8_t>(gpios_ >> 8);
+            response[1] = static_cast<uint8_t>(gpios_);
+            size = CP2130::GET_GPIO_VALUES_WLEN;
+            break;
+        case CP2130::GET_GPIO_MODE_AND_LEVEL:
+            response[0] = static_cast<uint8_t>(gpioOutputs_ >> 8);
+            response[1] = static_cast<uint8_t>(gpioOutputs_);
+            response[2] = static_cast<uint8_t>(gpios_ >> 8);
+            response[3] = static_cast<uint8_t>(gpios_);
+            size = CP2130::GET_GPIO_MODE_AND_LEVEL_WLEN;
+            break;
+        case CP2130::GET_GPIO_CHIP_SELECT:
+        {
+            uint16_t pins = 0x0000;
+            for (uint8_t i = 0; i < 11; ++i) {
+                if ((0x0001 << i & csEnabled_) != 0x0000) {
+                    pins = static_cast<uint16_t>(pins | pinBitmap(i));
+                }
+            }
+            response[0] = static_cast<uint8_t>(csEnabled_ >> 8);
+            response[1] = static_cast<uint8_t>(csEnabled_);
+            response[2] = static_cast<uint8_t>(pins >> 8);
+            response[3] = static_cast<uint8_t>(pins);
+            size = CP2130::GET_GPIO_CHIP_SELECT_WLEN;
+            break;
+        }
+        case CP2130::GET_SPI_WORD:
+            std::copy(spiWords_, spiWords_ + sizeof(spiWords_), response);
+            size = CP2130::GET_SPI_WORD_WLEN;
+            break;
+        case CP2130::GET_SPI_DELAY:
+            valid = wIndex <= 10;
+            if (valid) {
+                std::copy(spiDelays_[wIndex], spiDelays_[wIndex] + CP2130::GET_SPI_DELAY_WLEN, response);
+            }
+            size = CP2130::GET_SPI_DELAY_WLEN;
+            break;
+        case CP2130::GET_FULL_THRESHOLD:
+            response[0] = fifoThreshold_;
+            size = CP2130::GET_FULL_THRESHOLD_WLEN;
+            break;
+        case CP2130::GET_RTR_STATE:
+            response[0] = 0x00;  // ReadWithRTR commands complete immediately, so RTR is never reported as active
+            size = CP2130::GET_RTR_STATE_WLEN;
+            break;
+        case CP2130::GET_EVENT_COUNTER:
+            std::copy(eventCounter_, eventCounter_ + sizeof(eventCounter_), response);
+            size = CP2130::GET_EVENT_COUNTER_WLEN;
+            break;
+        case CP2130::GET_CLOCK_DIVIDER:
+            response[0] = clockDivider_;
+            size = CP2130::GET_CLOCK_DIVIDER_WLEN;
+            break;
+        case CP2130::GET_USB_CONFIG:
+            index = CP2130::PROMIDX_VID;
+            fieldSize = CP2130::GET_USB_CONFIG_WLEN;  // The USB config fields are contiguous, and laid out as returned by this request
+            size = CP2130::GET_USB_CONFIG_WLEN;
+            break;
+        case CP2130::GET_MANUFACTURING_STRING_1:
+            index = CP2130::PROMIDX_MANUFACTURING_STRING_1;
+            fieldSize = CP2130::PROMSZE_MANUFACTURING_STRING_1;
+            size = CP2130::GET_MANUFACTURING_STRING_1_WLEN;
+            break;
+        case CP2130::GET_MANUFACTURING_STRING_2:
+            index = CP2130::PROMIDX_MANUFACTURING_STRING_2;
+            fieldSize = CP2130::PROMSZE_MANUFACTURING_STRING_2;
+            size = CP2130::GET_MANUFACTURING_STRING_2_WLEN;
+            break;
+        case CP2130::GET_PRODUCT_STRING_1:
+            index = CP2130::PROMIDX_PRODUCT_STRING_1;
+            fieldSize = CP2130::PROMSZE_PRODUCT_STRING_1;
+            size = CP2130::GET_PRODUCT_STRING_1_WLEN;
+            break;
+        case CP2130::GET_PRODUCT_STRING_2:
+            index = CP2130::PROMIDX_PRODUCT_STRING_2;
+            fieldSize = CP2130::PROMSZE_PRODUCT_STRING_2;
+            size = CP2130::GET_PRODUCT_STRING_2_WLEN;
+            break;
+        case CP2130::GET_SERIAL_STRING:
+            index = CP2130::PROMIDX_SERIAL_STRING;
+            fieldSize = CP2130::PROMSZE_SERIAL_STRING;
+            size = CP2130::GET_SERIAL_STRING_WLEN;
+            break;
+        case CP2130::GET_PIN_CONFIG:
+            index = CP2130::PROMIDX_PIN_CONFIG;
+            fieldSize = CP2130::PROMSZE_PIN_CONFIG;
+            size = CP2130::GET_PIN_CONFIG_WLEN;
+            break;
+        case CP2130::GET_LOCK_BYTE:
+            index = CP2130::PROMIDX_LOCK_BYTE;
+            fieldSize = CP2130::PROMSZE_LOCK_BYTE;
+            size = CP2130::GET_LOCK_BYTE_WLEN;
+            break;
+        case CP2130::GET_PROM_CONFIG:
+            valid = wIndex < CP2130::PROM_BLOCKS;
+            index = CP2130::PROM_BLOCK_SIZE * wIndex;
+            fieldSize = CP2130::PROM_BLOCK_SIZE;
+            size = CP2130::GET_PROM_CONFIG_WLEN;
+            break;
+        default:
+            valid = false;
+            break;
+    }
+    int result;
+    if (!valid || wLength != size) {
+        result = LIBUSB_ERROR_PIPE;  // The CP2130 stalls the control pipe
+    } else {
+        for (size_t i = 0; i < fieldSize; ++i) {
+            response[i] = prom_[index + i];
+        }
+        std::copy(response, response + size, data);
+        result = static_cast<int>(size);
+    }
+    return result;
+}
+
+// Private function that handles host-to-device vendor requests, returning the number of bytes transferred, or LIBUSB_ERROR_PIPE if the request is not valid
+// Requests that write to the OTP ROM require the write key, and fail if the corresponding lock bits are cleared
+int CP2130Simulator::handleSet(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const unsigned char *data, uint16_t wLength)
+{
+    size_t size = 0;
+    bool known = true, otp = false;
+    switch (bRequest) {
+        case CP2130::RESET_DEVICE:
+            size = CP2130::RESET_DEVICE_WLEN;
+            break;
+        case CP2130::SET_GPIO_VALUES:
+            size = CP2130::SET_GPIO_VALUES_WLEN;
+            break;
+        case CP2130::SET_GPIO_MODE_AND_LEVEL:
+            size = CP2130::SET_GPIO_MODE_AND_LEVEL_WLEN;
+            break;
+        case CP2130::SET_GPIO_CHIP_SELECT:
+            size = CP2130::SET_GPIO_CHIP_SELECT_WLEN;
+            break;
+        case CP2130::SET_SPI_WORD:
+            size = CP2130::SET_SPI_WORD_WLEN;
+            break;
+        case CP2130::SET_SPI_DELAY:
+            size = CP2130::SET_SPI_DELAY_WLEN;
+            break;
+        case CP2130::SET_FULL_THRESHOLD:
+            size = CP2130::SET_FULL_THRESHOLD_WLEN;
+            break;
+        case CP2130::SET_RTR_STOP:
+            size = CP2130::SET_RTR_STOP_WLEN;
+            break;
+        case CP2130::SET_EVENT_COUNTER:
+            size = CP2130::SET_EVENT_COUNTER_WLEN;
+            break;
+        case CP2130::SET_CLOCK_DIVIDER:
+            size = CP2130::SET_CLOCK_DIVIDER_WLEN;
+            break;
+        case CP2130::SET_USB_CONFIG:
+            size = CP2130::SET_USB_CONFIG_WLEN;
+            otp = true;
+            break;
+        case CP2130::SET_MANUFACTURING_STRING_1:
+        case CP2130::SET_MANUFACTURING_STRING_2:
+        case CP2130::SET_PRODUCT_STRING_1:
+        case CP2130::SET_PRODUCT_STRING_2:
+        case CP2130::SET_SERIAL_STRING:
+            size = CP2130::SET_SERIAL_STRING_WLEN;  // All string requests share the same data stage length
+            otp = true;
+            break;
+        case CP2130::SET_PIN_CONFIG:
+            size = CP2130::SET_PIN_CONFIG_WLEN;
+            otp = true;
+            break;
+        case CP2130::SET_LOCK_BYTE:
+            size = CP2130::SET_LOCK_BYTE_WLEN;
+            otp = true;
+            break;
+        case CP2130::SET_PROM_CONFIG:
+            size = CP2130::SET_PROM_CONFIG_WLEN;
+            otp = true;
+            break;
+        default:
+            known = false;
+            break;
+    }
+    uint16_t lock = static_cast<uint16_t>(prom_[CP2130::PROMIDX_LOCK_BYTE + 1] << 8 | prom_[CP2130::PROMIDX_LOCK_BYTE]);
+    bool valid = known && wLength == size && (!otp || wValue == CP2130::PROM_WRITE_KEY);
+    size_t index = 0, fieldSize = 0;  // Applicable to requests that write an OTP ROM field, as a whole
+    uint16_t lockMask = 0x0000;
+    if (valid) {
+        switch (bRequest) {
+            case CP2130::RESET_DEVICE:
+                resetVolatileState();
+                break;
+            case CP2130::SET_GPIO_VALUES:
+            {
+                uint16_t values = static_cast<uint16_t>(data[0] << 8 | data[1]);
+                uint16_t mask = static_cast<uint16_t>(CP2130::BMGPIOS & (data[2] << 8 | data[3]));
+                gpios_ = static_cast<uint16_t>((~mask & gpios_) | (mask & values));
+                break;
+            }
+            case CP2130::SET_GPIO_MODE_AND_LEVEL:
+                valid = data[0] <= 10;
+                if (valid) {
+                    uint16_t bitmap = pinBitmap(data[0]);
+                    if (data[1] == CP2130::PCOUTOD || data[1] == CP2130::PCOUTPP) {
+                        gpioOutputs_ = static_cast<uint16_t>(gpioOutputs_ | bitmap);
+                        gpios_ = static_cast<uint16_t>(data[2] != 0x00 ? gpios_ | bitmap : gpios_ & ~bitmap);
+                    } else {
+                        gpioOutputs_ = static_cast<uint16_t>(gpioOutputs_ & ~bitmap);
+                    }
+                }
+                break;
+            case CP2130::SET_GPIO_CHIP_SELECT:
+                valid = data[0] <= 10 && data[1] <= 0x02;
+                if (valid) {
+                    uint16_t bitmap = static_cast<uint16_t>(0x0001 << data[0]);
+                    if (data[1] == 0x00) {
+                        csEnabled_ = static_cast<uint16_t>(csEnabled_ & ~bitmap);
+                    } else if (data[1] == 0x01) {
+                        csEnabled_ = static_cast<uint16_t>(csEnabled_ | bitmap);
+                    } else {
+                        csEnabled_ = bitmap;  // Enable only the given channel
+                    }
+                }
+                break;
+            case CP2130::SET_SPI_WORD:
+                valid = data[0] <= 10;
+                if (valid) {
+                    spiWords_[data[0]] = data[1];
+                }
+                break;
+            case CP2130::SET_SPI_DELAY:
+                valid = data[0] <= 10;
+                if (valid) {
+                    std::copy(data, data + CP2130::SET_SPI_DELAY_WLEN, spiDelays_[data[0]]);
+                }
+                break;
+            case CP2130::SET_FULL_THRESHOLD:
+                fifoThreshold_ = data[0];
+                break;
+            case CP2130::SET_RTR_STOP:  // ReadWithRTR commands complete immediately, so there is nothing to abort
+                break;
+            case CP2130::SET_EVENT_COUNTER:
+                eventCounter_[0] = static_cast<uint8_t>(0x07 & data[0]);  // This also clears the overflow flag
+                eventCounter_[1] = data[1];
+                eventCounter_[2] = data[2];
+                break;
+            case CP2130::SET_CLOCK_DIVIDER:
+                clockDivider_ = data[0];
+                break;
+            case CP2130::SET_USB_CONFIG:
+            {
+                uint8_t mask = static_cast<uint8_t>(lock & data[9]);  // Locked fields are left untouched
+                if ((CP2130::LWVID & mask) != 0x00) {
+                    std::copy(data + CP2130::PROMIDX_VID, data + CP2130::PROMIDX_VID + CP2130::PROMSZE_VID, &prom_[CP2130::PROMIDX_VID]);
+                }
+                if ((CP2130::LWPID & mask) != 0x00) {
+                    std::copy(data + CP2130::PROMIDX_PID, data + CP2130::PROMIDX_PID + CP2130::PROMSZE_PID, &prom_[CP2130::PROMIDX_PID]);
+                }
+                if ((CP2130::LWMAXPOW & mask) != 0x00) {
+                    prom_[CP2130::PROMIDX_MAX_POWER] = data[CP2130::PROMIDX_MAX_POWER];
+                }
+                if ((CP2130::LWPOWMODE & mask) != 0x00) {
+                    prom_[CP2130::PROMIDX_POWER_MODE] = data[CP2130::PROMIDX_POWER_MODE];
+                }
+                if ((CP2130::LWREL & mask) != 0x00) {
+                    std::copy(data + CP2130::PROMIDX_RELEASE_VERSION, data + CP2130::PROMIDX_RELEASE_VERSION + CP2130::PROMSZE_RELEASE_VERSION, &prom_[CP2130::PROMIDX_RELEASE_VERSION]);
+                }
+                if ((CP2130::LWTRFPRIO & mask) != 0x00) {
+                    prom_[CP2130::PROMIDX_TRANSFER_PRIORITY] = data[CP2130::PROMIDX_TRANSFER_PRIORITY];
+                }
+                break;
+            }
+            case CP2130::SET_MANUFACTURING_STRING_1:
+                index = CP2130::PROMIDX_MANUFACTURING_STRING_1;
+                fieldSize = CP2130::PROMSZE_MANUFACTURING_STRING_1;
+                lockMask = 0x0020;
+                break;
+            case CP2130::SET_MANUFACTURING_STRING_2:
+                index = CP2130::PROMIDX_MANUFACTURING_STRING_2;
+                fieldSize = CP2130::PROMSZE_MANUFACTURING_STRING_2;
+                lockMask = 0x0040;
+                break;
+            case CP2130::SET_PRODUCT_STRING_1:
+                index = CP2130::PROMIDX_PRODUCT_STRING_1;
+                fieldSize = CP2130::PROMSZE_PRODUCT_STRING_1;
+                lockMask = 0x0100;
+                break;
+            case CP2130::SET_PRODUCT_STRING_2:
+                index = CP2130::PROMIDX_PRODUCT_STRING_2;
+                fieldSize = CP2130::PROMSZE_PRODUCT_STRING_2;
+                lockMask = 0x0200;
+                break;
+            case CP2130::SET_SERIAL_STRING:
+                index = CP2130::PROMIDX_SERIAL_STRING;
+                fieldSize = CP2130::PROMSZE_SERIAL_STRING;
+                lockMask = CP2130::LWSER;
+                break;
+            case CP2130::SET_PIN_CONFIG:
+                index = CP2130::PROMIDX_PIN_CONFIG;
+                fieldSize = CP2130::PROMSZE_PIN_CONFIG;
+                lockMask = CP2130::LWPINCFG;
+                break;
+            case CP2130::SET_LOCK_BYTE:
+                prom_[CP2130::PROMIDX_LOCK_BYTE] = static_cast<uint8_t>(prom_[CP2130::PROMIDX_LOCK_BYTE] & data[0]);  // Lock bits can only be cleared
+                prom_[CP2130::PROMIDX_LOCK_BYTE + 1] = static_cast<uint8_t>(prom_[CP2130::PROMIDX_LOCK_BYTE + 1] & data[1]);
+                break;
+            case CP2130::SET_PROM_CONFIG:
+                valid = wIndex < CP2130::PROM_BLOCKS && lock == 0xffff;  // The OTP ROM can only be written as a whole while blank
+                index = CP2130::PROM_BLOCK_SIZE * wIndex;
+                fieldSize = CP2130::PROM_BLOCK_SIZE;
+                lockMask = 0xffff;
+                break;
+        }
+        if (valid && fieldSize != 0) {
+            valid = (lockMask & lock) == lockMask;
+            if (valid) {
+                for (size_t i = 0; i < fieldSize; ++i) {
+                    prom_[index + i] = data[i];
+                }
+            }
+        }
+    }
+    return valid ? static_cast<int>(size) : LIBUSB_ERROR_PIPE;
+}
+
+// Private procedure that brings both the CP2130 and the LTC2640 to their power-on state
+void CP2130Simulator::powerOn()
+{
+    resetVolatileState();
+    dacInput_ = 0x0000;  // The LTC2640 powers up at zero-scale, using its internal reference
+    dacCode_ = 0x0000;
+    dacExternalRef_ = false;
+    dacPoweredDown_ = false;
+}
+
+// Private procedure that resets the volatile state of the CP2130, as it happens after a reset (the LTC2640 is not affected)
+void CP2130Simulator::resetVolatileState()
+{
+    gpios_ = CP2130::BMGPIOS;
+    gpioOutputs_ = 0x0000;
+    csEnabled_ = 0x0000;
+    for (uint8_t i = 0; i < 11; ++i) {
+        spiWords_[i] = 0x00;
+        std::fill(spiDelays_[i], spiDelays_[i] + CP2130::SET_SPI_DELAY_WLEN, 0x00);
+        spiDelays_[i][0] = i;  // Byte 0 holds the channel number
+    }
+    clockDivider_ = 0x00;
+    fifoThreshold_ = SIM_FIFOTHRESHOLD;
+    std::fill(eventCounter_, eventCounter_ + sizeof(eventCounter_), 0x00);
+    headerBytes_ = 0;  // Any command in progress is aborted
+    bytesRemaining_ = 0;
+    frame_.clear();
+    inQueue_.clear();
+}
+
+// Private procedure that writes the given descriptor to the OTP ROM field(s) starting at the given index, in the USB string descriptor format
+void CP2130Simulator::writeString(size_t index, size_t size, const std::u16string &descriptor)
+{
+    size_t length = std::min(2 * descriptor.size() + 2, size);
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t value;
+        if (i == 0) {
+            value = static_cast<uint8_t>(length);  // USB string descriptor length
+        } else if (i == 1) {
+            value = 0x03;  // USB string descriptor constant
+        } else if (i < length) {
+            value = static_cast<uint8_t>(descriptor[(i - 2) / 2] >> (i % 2 == 0 ? 0 : 8));  // UTF-16LE conversion as per the USB 2.0 specification
+        } else {
+            value = 0x00;
+        }
+        prom_[index + i] = value;
+    }
+}
+
+// Private static function that returns the GPIO bitmap (see the values applicable to getGPIOs()/setGPIOs()) corresponding to the given pin
+uint16_t CP2130Simulator::pinBitmap(uint8_t pin)
+{
+    return static_cast<uint16_t>(pin < 6 ? CP2130::BMGPIO0 << pin : CP2130::BMGPIO6 << (pin - 6));
+}
+
+// Creates a simulator having the configuration of a blank CP2130
+CP2130Simulator::CP2130Simulator() :
+    CP2130Simulator(SIM_DEFAULTCONFIG, u"Silicon Laboratories", u"CP2130 USB-to-SPI Bridge", u"0001")
+{
+}
+
+// Creates a simulator having the given USB configuration and descriptors
+CP2130Simulator::CP2130Simulator(const CP2130::USBConfig &config, const std::u16string &manufacturer, const std::u16string &product, const std::u16string &serial) :
+    mutex_(),
+    connected_(true),
+    failureResult_(LIBUSB_SUCCESS),
+    failuresPending_(0),
+    bulkTransfers_(0),
+    controlTransfers_(0),
+    loopback_(false),
+    prom_(),
+    gpios_(0x0000),
+    gpioOutputs_(0x0000),
+    csEnabled_(0x0000),
+    spiWords_(),
+    spiDelays_(),
+    clockDivider_(0x00),
+    fifoThreshold_(0x00),
+    eventCounter_(),
+    header_(),
+    headerBytes_(0),
+    command_(0x00),
+    bytesRemaining_(0),
+    frame_(),
+    inQueue_(),
+    dacInput_(0x0000),
+    dacCode_(0x0000),
+    dacExternalRef_(false),
+    dacPoweredDown_(false),
+    dacFrames_(0),
+    dacFrameErrors_(0),
+    dacUpdates_(0)
+{
+    prom_[CP2130::PROMIDX_VID] = static_cast<uint8_t>(config.vid);
+    prom_[CP2130::PROMIDX_VID + 1] = static_cast<uint8_t>(config.vid >> 8);
+    prom_[CP2130::PROMIDX_PID] = static_cast<uint8_t>(config.pid);
+    prom_[CP2130::PROMIDX_PID + 1] = static_cast<uint8_t>(config.pid >> 8);
+    prom_[CP2130::PROMIDX_MAX_POWER] = config.maxpow;
+    prom_[CP2130::PROMIDX_POWER_MODE] = config.powmode;
+    prom_[CP2130::PROMIDX_RELEASE_VERSION] = config.majrel;
+    prom_[CP2130::PROMIDX_RELEASE_VERSION + 1] = config.minrel;
+    prom_[CP2130::PROMIDX_TRANSFER_PRIORITY] = config.trfprio;
+    writeString(CP2130::PROMIDX_MANUFACTURING_STRING_1, CP2130::PROMSZE_MANUFACTURING_STRING_1 + CP2130::PROMSZE_MANUFACTURING_STRING_2, manufacturer);  // Both fields are contiguous
+    writeString(CP2130::PROMIDX_PRODUCT_STRING_1, CP2130::PROMSZE_PRODUCT_STRING_1 + CP2130::PROMSZE_PRODUCT_STRING_2, product);  // Same as above
+    writeString(CP2130::PROMIDX_SERIAL_STRING, CP2130::PROMSZE_SERIAL_STRING, serial);
+    for (size_t i = 0; i < 11; ++i) {
+        prom_[CP2130::PROMIDX_PIN_CONFIG + i] = CP2130::PCCS;  // Every GPIO pin is configured as a chip select
+    }
+    prom_[CP2130::PROMIDX_LOCK_BYTE] = 0xff;  // The OTP ROM is not locked
+    prom_[CP2130::PROMIDX_LOCK_BYTE + 1] = 0xff;
+    powerOn();
+}
+
+// Returns the number of bulk transfers carried out so far
+size_t CP2130Simulator::bulkTransfers() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bulkTransfers_;
+}
+
+// Returns the number of control transfers carried out so far
+size_t CP2130Simulator::controlTransfers() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return controlTransfers_;
+}
+
+// Returns the code held by the DAC register of the LTC2640
+uint16_t CP2130Simulator::dacCode() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacCode_;
+}
+
+// Returns the number of frames that were discarded by the LTC2640 (e.g. because they were shorter than 24 bits, or because the SPI mode was not suitable)
+size_t CP2130Simulator::dacFrameErrors() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacFrameErrors_;
+}
+
+// Returns the number of frames received by the LTC2640, including the discarded ones
+size_t CP2130Simulator::dacFrames() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacFrames_;
+}
+
+// Returns the code held by the input register of the LTC2640
+uint16_t CP2130Simulator::dacInputCode() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacInput_;
+}
+
+// Returns the number of times the DAC register of the LTC2640 was updated
+size_t CP2130Simulator::dacUpdates() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacUpdates_;
+}
+
+// Returns the output voltage of the LTC2640, according to the selected reference
+float CP2130Simulator::dacVoltage() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacPoweredDown_ ? 0 : dacCode_ * (dacExternalRef_ ? DAC_VEXTREF : DAC_VINTREF) / 4096;
+}
+
+// Checks if the simulated device is connected
+bool CP2130Simulator::isConnected() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connected_;
+}
+
+// Checks if the LTC2640 is powered down
+bool CP2130Simulator::isDACPoweredDown() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacPoweredDown_;
+}
+
+// Checks if the LTC2640 is using the external reference
+bool CP2130Simulator::isDACReferenceExternal() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dacExternalRef_;
+}
+
+// Carries out a simulated bulk transfer, using the endpoint addresses that correspond to the transfer priority
+int CP2130Simulator::bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    (void)timeout;  // Transfers complete immediately
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++bulkTransfers_;
+    if (transferred != nullptr) {
+        *transferred = 0;
+    }
+    bool prioWrite = prom_[CP2130::PROMIDX_TRANSFER_PRIORITY] == CP2130::PRIOWRITE;
+    int result;
+    if (!connected_) {
+        result = LIBUSB_ERROR_NO_DEVICE;
+    } else if (failuresPending_ != 0) {
+        --failuresPending_;
+        result = failureResult_;
+    } else if (length < 0 || (data == nullptr && length != 0)) {
+        result = LIBUSB_ERROR_INVALID_PARAM;
+    } else if (endpointAddr == (prioWrite ? 0x01 : 0x02)) {
+        result = handleBulkOut(data, length, transferred);
+    } else if (endpointAddr == (prioWrite ? 0x82 : 0x81)) {
+        result = handleBulkIn(data, length, transferred);
+    } else {
+        result = LIBUSB_ERROR_PIPE;
+    }
+    return result;
+}
+
+// Resets all counters
+void CP2130Simulator::clearCounters()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bulkTransfers_ = 0;
+    controlTransfers_ = 0;
+    dacFrames_ = 0;
+    dacFrameErrors_ = 0;
+    dacUpdates_ = 0;
+}
+
+// Carries out a simulated control transfer
+int CP2130Simulator::controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, unsigned int timeout)
+{
+    (void)timeout;  // Transfers complete immediately
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++controlTransfers_;
+    int result;
+    if (!connected_) {
+        result = LIBUSB_ERROR_NO_DEVICE;
+    } else if (failuresPending_ != 0) {
+        --failuresPending_;
+        result = failureResult_;
+    } else if (data == nullptr && wLength != 0) {
+        result = LIBUSB_ERROR_INVALID_PARAM;
+    } else if (bmRequestType == CP2130::GET) {
+        result = handleGet(bRequest, wIndex, data, wLength);
+    } else if (bmRequestType == CP2130::SET) {
+        result = handleSet(bRequest, wValue, wIndex, data, wLength);
+    } else {
+        result = LIBUSB_ERROR_PIPE;
+    }
+    return result;
+}
+
+// Causes the given number of subsequent transfers, of either type, to fail with the given libusb error code, without any effect
+void CP2130Simulator::injectFailures(int result, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    failureResult_ = result;
+    failuresPending_ = count;
+}
+
+// Simulates a disconnect, after which every transfer fails with LIBUSB_ERROR_NO_DEVICE, or a reconnect, which brings the simulated device to its power-on state
+void CP2130Simulator::setConnected(bool connected)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connected && !connected_) {
+        powerOn();
+    }
+    connected_ = connected;
+}
+
+// Enables or disables the loopback, which, if enabled, causes the data clocked out of MOSI to be clocked back into MISO
+void CP2130Simulator::setLoopback(bool loopback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    loopback_ = loopback;
+}
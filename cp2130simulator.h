@@ -0,0 +1,103 @@
+/* CP2130 simulator class - Version 1.0.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef CP2130SIMULATOR_H
+#define CP2130SIMULATOR_H
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cp2130.h"
+#include "usbtransport.h"
+
+// In-memory simulation of a CP2130 having an LTC2640 DAC on channel 0, as found on the FAU201, to be passed to CP2130::open(USBTransport *) or FAU201Device::open(USBTransport *)
+// Control requests are validated in the same way as the CP2130 does (an unknown request or an unexpected data stage length causes a stall), while data sent to the bulk OUT endpoint is parsed as a stream of SPI commands
+// Timing is not simulated, so every transfer completes immediately, and the OTP ROM can be freely rewritten, although the lock word is honored
+class CP2130Simulator : public USBTransport
+{
+private:
+    mutable std::mutex mutex_;
+    bool connected_;
+    int failureResult_;
+    size_t failuresPending_;
+    size_t bulkTransfers_, controlTransfers_;
+    bool loopback_;
+    CP2130::PROMConfig prom_;
+    uint16_t gpios_, gpioOutputs_, csEnabled_;
+    uint8_t spiWords_[11];
+    uint8_t spiDelays_[11][CP2130::SET_SPI_DELAY_WLEN];
+    uint8_t clockDivider_, fifoThreshold_;
+    uint8_t eventCounter_[CP2130::GET_EVENT_COUNTER_WLEN];
+    uint8_t header_[8];
+    size_t headerBytes_;
+    uint8_t command_;
+    uint32_t bytesRemaining_;
+    std::vector<uint8_t> frame_;
+    std::deque<uint8_t> inQueue_;
+    uint16_t dacInput_, dacCode_;
+    bool dacExternalRef_, dacPoweredDown_;
+    size_t dacFrames_, dacFrameErrors_, dacUpdates_;
+
+    uint8_t clockByte(uint8_t mosi);
+    void endFrame();
+    int handleBulkIn(unsigned char *data, int length, int *transferred);
+    int handleBulkOut(const unsigned char *data, int length, int *transferred);
+    int handleGet(uint8_t bRequest, uint16_t wIndex, unsigned char *data, uint16_t wLength);
+    int handleSet(uint8_t bRequest, uint16_t wValue, uint16_t wIndex, const unsigned char *data, uint16_t wLength);
+    void powerOn();
+    void resetVolatileState();
+    void writeString(size_t index, size_t size, const std::u16string &descriptor);
+
+    static uint16_t pinBitmap(uint8_t pin);
+
+public:
+    // The following values are applicable to the LTC2640 model
+    static constexpr float DAC_VEXTREF = 4.096;  // External reference voltage, as used by the FAU201
+    static constexpr float DAC_VINTREF = 2.5;    // Internal reference voltage (LTC2640-L)
+
+    CP2130Simulator();
+    CP2130Simulator(const CP2130::USBConfig &config, const std::u16string &manufacturer, const std::u16string &product, const std::u16string &serial);
+
+    size_t bulkTransfers() const;
+    size_t controlTransfers() const;
+    uint16_t dacCode() const;
+    size_t dacFrameErrors() const;
+    size_t dacFrames() const;
+    uint16_t dacInputCode() const;
+    size_t dacUpdates() const;
+    float dacVoltage() const;
+    bool isConnected() const;
+    bool isDACPoweredDown() const;
+    bool isDACReferenceExternal() const;
+
+    int bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout) override;
+    void clearCounters();
+    int controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, unsigned int timeout) override;
+    void injectFailures(int result, size_t count);
+    void setConnected(bool connected);
+    void setLoopback(bool loopback);
+};
+
+#endif  // CP2130SIMULATOR_H
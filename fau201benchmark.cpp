@@ -0,0 +1,334 @@
+/* FAU201 benchmark class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include "fau201benchmark.h"
+
+// Definitions
+const size_t BENCH_CHUNKSIZE = 56;  // Maximum payload of each WriteRead command (see benchmarkSPIWriteReadStopAndWait())
+
+// Private function that times the given operation over the configured number of iterations, after an untimed one, and summarizes the latencies
+// The operation reports its errors as usual, and only the first failure is appended to "errcnt" and "errstr", so that a failing device does not flood them
+FAU201Benchmark::Result FAU201Benchmark::measure(const std::string &name, size_t bytes, const std::function<void(int &, std::string &)> &operation, int &errcnt, std::string &errstr) const
+{
+    Result result = {name, iterations_, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    std::vector<double> latencies;
+    latencies.reserve(iterations_);
+    std::string firsterrstr;
+    {
+        int warmerrcnt = 0;
+        std::string warmerrstr;
+        operation(warmerrcnt, warmerrstr);  // Untimed iteration, whose failure is not accounted for
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations_; ++i) {
+        int iterrcnt = 0;
+        std::string iterrstr;
+        std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+        operation(iterrcnt, iterrstr);
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count());
+        if (iterrcnt != 0) {
+            if (result.failures == 0) {
+                firsterrstr = iterrstr;
+            }
+            ++result.failures;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (size_t i = 0; i < latencies.size(); ++i) {
+        total += latencies[i];
+    }
+    result.mean = total / static_cast<double>(latencies.size());
+    result.min = latencies.front();
+    result.p50 = latencies[static_cast<size_t>(std::ceil(0.5 * static_cast<double>(latencies.size()))) - 1];
+    result.p99 = latencies[static_cast<size_t>(std::ceil(0.99 * static_cast<double>(latencies.size()))) - 1];
+    result.max = latencies.back();
+    result.throughput = elapsed > 0 ? static_cast<double>(bytes) * static_cast<double>(iterations_) / elapsed : 0.0;
+    if (result.failures != 0) {
+        ++errcnt;
+        errstr += firsterrstr;
+    }
+    return result;
+}
+
+// "Equal to" operator for Result
+bool FAU201Benchmark::Result::operator ==(const FAU201Benchmark::Result &other) const
+{
+    return name == other.name && iterations == other.iterations && failures == other.failures && mean == other.mean && min == other.min && p50 == other.p50 && p99 == other.p99 && max == other.max && throughput == other.throughput;
+}
+
+// "Not equal to" operator for Result
+bool FAU201Benchmark::Result::operator !=(const FAU201Benchmark::Result &other) const
+{
+    return !(operator ==(other));
+}
+
+// Each benchmark runs the given number of timed iterations, which is at least one
+FAU201Benchmark::FAU201Benchmark(size_t iterations) :
+    iterations_(std::max(iterations, static_cast<size_t>(1)))
+{
+}
+
+// Returns the number of timed iterations of each benchmark
+size_t FAU201Benchmark::iterations() const
+{
+    return iterations_;
+}
+
+// Measures a full read of the OTP ROM, which is invalidated before each iteration, so that every iteration reads it from the device (see CP2130::getPROMConfig())
+FAU201Benchmark::Result FAU201Benchmark::benchmarkGetPROMConfig(CP2130 &cp2130, int &errcnt, std::string &errstr) const
+{
+    Result result = {"getPROMConfig", 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (!cp2130.isOpen()) {
+        ++errcnt;
+        errstr += "In benchmarkGetPROMConfig(): device is not open.\n";  // Program logic error
+    } else {
+        result = measure(result.name, CP2130::PROM_SIZE, [&cp2130](int &operrcnt, std::string &operrstr) {
+            cp2130.invalidatePROM();
+            cp2130.getPROMConfig(operrcnt, operrstr);
+        }, errcnt, errstr);
+        cp2130.invalidatePROM();  // The last copy read is not kept, as it would not have been cached otherwise
+    }
+    return result;
+}
+
+// Measures a scan of the bus for FAU201 devices, which requires real hardware, since CP2130Simulator is not visible to libusb (see FAU201Device::listDevices())
+FAU201Benchmark::Result FAU201Benchmark::benchmarkListDevices(int &errcnt, std::string &errstr) const
+{
+    std::vector<std::string> devices;
+    return measure("listDevices", 0, [&devices](int &operrcnt, std::string &operrstr) {
+        FAU201Device::listDevices(devices, operrcnt, operrstr);
+    }, errcnt, errstr);
+}
+
+// Measures opening and then closing a device on each of the given transports, such as a set of CP2130Simulator objects, one after the other
+FAU201Benchmark::Result FAU201Benchmark::benchmarkOpen(const std::vector<USBTransport *> &transports, int &errcnt, std::string &errstr) const
+{
+    std::ostringstream stream;
+    stream << "open (" << transports.size() << " devices)";
+    Result result = {stream.str(), 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (transports.empty() || std::find(transports.begin(), transports.end(), nullptr) != transports.end()) {
+        ++errcnt;
+        errstr += "In benchmarkOpen(): Transports must not be empty or null.\n";  // Program logic error
+    } else {
+        std::vector<FAU201Device> devices(transports.size());
+        result = measure(result.name, 0, [&transports, &devices](int &operrcnt, std::string &operrstr) {
+            for (size_t i = 0; i < transports.size(); ++i) {
+                if (devices[i].open(transports[i]) != FAU201Device::SUCCESS) {
+                    ++operrcnt;
+                    operrstr += "Could not open device on the given transport.\n";
+                }
+            }
+            for (size_t i = 0; i < devices.size(); ++i) {
+                devices[i].close();
+            }
+        }, errcnt, errstr);
+    }
+    return result;
+}
+
+// Measures opening and then closing each device having one of the given serial numbers, as returned by FAU201Device::listDevices(), one after the other
+// This requires real hardware, and each open() scans the bus again, as done by FAU201Device::open(const std::string &)
+FAU201Benchmark::Result FAU201Benchmark::benchmarkOpen(const std::vector<std::string> &serials, int &errcnt, std::string &errstr) const
+{
+    std::ostringstream stream;
+    stream << "open (" << serials.size() << " devices)";
+    Result result = {stream.str(), 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (serials.empty()) {
+        ++errcnt;
+        errstr += "In benchmarkOpen(): No serial numbers were given.\n";  // Program logic error
+    } else {
+        std::vector<FAU201Device> devices(serials.size());
+        result = measure(result.name, 0, [&serials, &devices](int &operrcnt, std::string &operrstr) {
+            for (size_t i = 0; i < serials.size(); ++i) {
+                if (devices[i].open(serials[i]) != FAU201Device::SUCCESS) {
+                    ++operrcnt;
+                    operrstr += "Could not open device with serial number " + serials[i] + ".\n";
+                }
+            }
+            for (size_t i = 0; i < devices.size(); ++i) {
+                devices[i].close();
+            }
+        }, errcnt, errstr);
+    }
+    return result;
+}
+
+// Measures a voltage update, alternating between two voltages, so that no update is skipped as redundant (see FAU201Device::setVoltage())
+// The device must be set up, and it is left at one of the two voltages
+FAU201Benchmark::Result FAU201Benchmark::benchmarkSetVoltage(FAU201Device &device, int &errcnt, std::string &errstr) const
+{
+    Result result = {"setVoltage", 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (!device.isOpen()) {
+        ++errcnt;
+        errstr += "In benchmarkSetVoltage(): device is not open.\n";  // Program logic error
+    } else {
+        bool high = false;
+        result = measure(result.name, 0, [&device, &high](int &operrcnt, std::string &operrstr) {
+            high = !high;
+            device.setVoltage(high ? 2.0f : 1.0f, operrcnt, operrstr);
+        }, errcnt, errstr);
+    }
+    return result;
+}
+
+// Measures an SPI read of the given size, from the channel whose chip select is enabled (see CP2130::spiRead())
+FAU201Benchmark::Result FAU201Benchmark::benchmarkSPIRead(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const
+{
+    std::ostringstream stream;
+    stream << "spiRead (" << size << " bytes)";
+    Result result = {stream.str(), 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (!cp2130.isOpen()) {
+        ++errcnt;
+        errstr += "In benchmarkSPIRead(): device is not open.\n";  // Program logic error
+    } else if (size == 0) {
+        ++errcnt;
+        errstr += "In benchmarkSPIRead(): Size must be greater than zero.\n";  // Program logic error
+    } else {
+        result = measure(result.name, size, [&cp2130, size](int &operrcnt, std::string &operrstr) {
+            cp2130.spiRead(static_cast<uint32_t>(size), operrcnt, operrstr);
+        }, errcnt, errstr);
+    }
+    return result;
+}
+
+// Measures an SPI write of the given size, to the channel whose chip select is enabled (see CP2130::spiWrite())
+// Zeros are written, which the LTC2640 of a FAU201 takes as writes to its input register, so that the output voltage is not affected
+FAU201Benchmark::Result FAU201Benchmark::benchmarkSPIWrite(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const
+{
+    std::ostringstream stream;
+    stream << "spiWrite (" << size << " bytes)";
+    Result result = {stream.str(), 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (!cp2130.isOpen()) {
+        ++errcnt;
+        errstr += "In benchmarkSPIWrite(): device is not open.\n";  // Program logic error
+    } else if (size == 0) {
+        ++errcnt;
+        errstr += "In benchmarkSPIWrite(): Size must be greater than zero.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> data(size, 0x00);
+        result = measure(result.name, size, [&cp2130, &data](int &operrcnt, std::string &operrstr) {
+            cp2130.spiWrite(data, operrcnt, operrstr);
+        }, errcnt, errstr);
+    }
+    return result;
+}
+
+// Measures an SPI write and read of the given size, using the pipelined implementation of CP2130::spiWriteRead() (see also the next function)
+// As in benchmarkSPIWrite(), zeros are written
+FAU201Benchmark::Result FAU201Benchmark::benchmarkSPIWriteRead(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const
+{
+    std::ostringstream stream;
+    stream << "spiWriteRead (" << size << " bytes)";
+    Result result = {stream.str(), 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (!cp2130.isOpen()) {
+        ++errcnt;
+        errstr += "In benchmarkSPIWriteRead(): device is not open.\n";  // Program logic error
+    } else if (size == 0) {
+        ++errcnt;
+        errstr += "In benchmarkSPIWriteRead(): Size must be greater than zero.\n";  // Program logic error
+    } else {
+        std::vector<uint8_t> data(size, 0x00);
+        result = measure(result.name, size, [&cp2130, &data](int &operrcnt, std::string &operrstr) {
+            cp2130.spiWriteRead(data, operrcnt, operrstr);
+        }, errcnt, errstr);
+    }
+    return result;
+}
+
+// Measures an SPI write and read of the given size, issued as one WriteRead command per 56-byte chunk, each followed by a synchronous read of its data
+// This reproduces the stop-and-wait loop used by CP2130::spiWriteRead() before version 1.3.0, as a baseline for the pipelined implementation measured by the previous function
+FAU201Benchmark::Result FAU201Benchmark::benchmarkSPIWriteReadStopAndWait(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const
+{
+    std::ostringstream stream;
+    stream << "spiWriteRead, stop-and-wait (" << size << " bytes)";
+    Result result = {stream.str(), 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (!cp2130.isOpen()) {
+        ++errcnt;
+        errstr += "In benchmarkSPIWriteReadStopAndWait(): device is not open.\n";  // Program logic error
+    } else if (size == 0) {
+        ++errcnt;
+        errstr += "In benchmarkSPIWriteReadStopAndWait(): Size must be greater than zero.\n";  // Program logic error
+    } else {
+        int preverrcnt = errcnt;
+        uint8_t endpointInAddr = cp2130.getEndpointInAddr(errcnt, errstr);
+        uint8_t endpointOutAddr = cp2130.getEndpointOutAddr(errcnt, errstr);
+        if (errcnt == preverrcnt) {
+            std::vector<std::vector<unsigned char>> commands;  // The commands are assembled beforehand, so that only the transfers are timed
+            for (size_t i = 0; i < size; i += BENCH_CHUNKSIZE) {
+                uint32_t payload = static_cast<uint32_t>(std::min(BENCH_CHUNKSIZE, size - i));
+                std::vector<unsigned char> command(payload + 8, 0x00);  // Zeros are written, as in benchmarkSPIWrite()
+                command[2] = CP2130::WRITEREAD;
+                command[4] = static_cast<uint8_t>(payload);
+                command[5] = static_cast<uint8_t>(payload >> 8);
+                commands.push_back(command);
+            }
+            std::vector<unsigned char> input(BENCH_CHUNKSIZE);
+            result = measure(result.name, size, [&cp2130, endpointInAddr, endpointOutAddr, &commands, &input](int &operrcnt, std::string &operrstr) {
+                int preverrcnt = operrcnt;
+                for (size_t i = 0; i < commands.size() && operrcnt == preverrcnt; ++i) {  // The loop is interrupted in case of error, as in CP2130::spiWriteRead()
+                    cp2130.bulkTransfer(endpointOutAddr, commands[i].data(), static_cast<int>(commands[i].size()), nullptr, operrcnt, operrstr);
+                    if (operrcnt == preverrcnt) {
+                        int bytesRead = 0;
+                        cp2130.bulkTransfer(endpointInAddr, input.data(), static_cast<int>(commands[i].size() - 8), &bytesRead, operrcnt, operrstr);
+                    }
+                }
+            }, errcnt, errstr);
+        }
+    }
+    return result;
+}
+
+// Sets the number of timed iterations of each benchmark
+void FAU201Benchmark::setIterations(size_t iterations, int &errcnt, std::string &errstr)
+{
+    if (iterations == 0) {
+        ++errcnt;
+        errstr += "In setIterations(): Number of iterations must be greater than zero.\n";  // Program logic error
+    } else {
+        iterations_ = iterations;
+    }
+}
+
+// Helper function that formats the given result as a single line, suitable for comparing runs against a baseline
+std::string FAU201Benchmark::formatResult(const Result &result)
+{
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1)
+           << result.name << ": "
+           << result.iterations << " iterations, "
+           << result.failures << " failures, latency mean "
+           << result.mean << "us, min "
+           << result.min << "us, p50 "
+           << result.p50 << "us, p99 "
+           << result.p99 << "us, max "
+           << result.max << "us";
+    if (result.throughput > 0) {
+        stream << ", throughput " << result.throughput << "B/s";
+    }
+    return stream.str();
+}
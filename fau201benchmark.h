@@ -0,0 +1,80 @@
+/* FAU201 benchmark class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+
+#ifndef FAU201BENCHMARK_H
+#define FAU201BENCHMARK_H
+
+// Includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "cp2130.h"
+#include "fau201device.h"
+#include "usbtransport.h"
+
+// Benchmark harness that measures the latency and throughput of the main transfer paths of CP2130 and FAU201Device, so that changes can be compared against a baseline
+// The devices are opened by the caller, either on a CP2130Simulator or on any other USBTransport, or on real hardware, as returned by FAU201Device::listDevices()
+// Since CP2130Simulator does not simulate timing, results obtained with it measure host-side overhead only, which is still what changes to the CP2130 class affect
+// Each benchmark runs one untimed iteration first, so that cached endpoint addresses and buffer allocations do not distort the results
+class FAU201Benchmark
+{
+public:
+    // Result of a benchmark, as returned by the functions below
+    struct Result {
+        std::string name;             // Name of the benchmark, including the payload size, if applicable
+        size_t iterations;            // Number of timed iterations
+        size_t failures;              // Number of iterations that failed
+        double mean, min, p50, p99, max;  // Latency of each iteration, in microseconds
+        double throughput;            // Payload throughput, in bytes per second (zero if not applicable)
+
+        bool operator ==(const Result &other) const;
+        bool operator !=(const Result &other) const;
+    };
+
+private:
+    size_t iterations_;
+
+    Result measure(const std::string &name, size_t bytes, const std::function<void(int &, std::string &)> &operation, int &errcnt, std::string &errstr) const;
+
+public:
+    explicit FAU201Benchmark(size_t iterations = 1000);
+
+    size_t iterations() const;
+
+    Result benchmarkGetPROMConfig(CP2130 &cp2130, int &errcnt, std::string &errstr) const;
+    Result benchmarkListDevices(int &errcnt, std::string &errstr) const;
+    Result benchmarkOpen(const std::vector<USBTransport *> &transports, int &errcnt, std::string &errstr) const;
+    Result benchmarkOpen(const std::vector<std::string> &serials, int &errcnt, std::string &errstr) const;
+    Result benchmarkSetVoltage(FAU201Device &device, int &errcnt, std::string &errstr) const;
+    Result benchmarkSPIRead(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const;
+    Result benchmarkSPIWrite(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const;
+    Result benchmarkSPIWriteRead(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const;
+    Result benchmarkSPIWriteReadStopAndWait(CP2130 &cp2130, size_t size, int &errcnt, std::string &errstr) const;
+    void setIterations(size_t iterations, int &errcnt, std::string &errstr);
+
+    static std::string formatResult(const Result &result);
+};
+
+#endif  // FAU201BENCHMARK_H
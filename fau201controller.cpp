@@ -0,0 +1,251 @@
+/* FAU201 controller class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <chrono>
+#include <cstring>
+#include <future>
+#include "fau201controller.h"
+
+// Definitions
+const uint32_t CTL_NOVOLTAGE = 0xffffffff;  // Value of the voltage slot when no voltage is pending (a NaN, thus never a valid voltage)
+const long CTL_IDLEPERIOD = 100;            // Maximum period, in milliseconds, that the I/O thread sleeps for while idle
+
+// Private procedure that sets the pending voltage, if any
+void FAU201Controller::applyVoltage(int &errcnt, std::string &errstr)
+{
+    uint32_t bits = pendingVoltage_.exchange(CTL_NOVOLTAGE);
+    if (bits != CTL_NOVOLTAGE) {
+        float voltage;
+        std::memcpy(&voltage, &bits, sizeof(voltage));
+        CP2130::Status status = device_.setVoltage(voltage);
+        if (status.code != CP2130::STATUS_OK) {
+            ++errcnt;
+            errstr += status.message();
+        }
+    }
+}
+
+// Private function that checks if any commands or voltages are pending (must be called from the I/O thread)
+bool FAU201Controller::hasWork() const
+{
+    return tail_ != &stub_ || head_.load() != &stub_ || pendingVoltage_.load() != CTL_NOVOLTAGE;
+}
+
+// Private function that removes the oldest node from the queue, returning a null pointer if there are none (must be called from the I/O thread)
+// This is the consumer side of an intrusive multi-producer single-consumer queue, where a stub node is kept so that the queue is never actually empty
+FAU201Controller::Node *FAU201Controller::pop()
+{
+    Node *node = nullptr;
+    Node *tail = tail_;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_ && next != nullptr) {  // The stub node is skipped
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (tail != &stub_) {
+        if (next == nullptr && tail == head_.load()) {  // The last node can only be removed once another one follows it, hence the stub node is pushed again
+            push(&stub_);
+            next = tail->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {  // Otherwise, a producer is halfway through a push, and the node will be available shortly
+            tail_ = next;
+            node = tail;
+        }
+    }
+    return node;
+}
+
+// Private procedure that appends the given node to the queue, which is wait-free and can be called from any thread
+void FAU201Controller::push(Node *node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node *prev = head_.exchange(node);
+    prev->next.store(node, std::memory_order_release);
+}
+
+// Private procedure run by the I/O thread, which executes the queued commands in order, followed by the pending voltage, if any
+// Errors are accumulated locally, and only published once per iteration
+void FAU201Controller::run()
+{
+    int errcnt = 0;
+    std::string errstr;
+    while (true) {
+        bool worked = false;
+        Node *node;
+        while ((node = pop()) != nullptr) {
+            if (node->command) {
+                node->command(device_, errcnt, errstr);
+            }
+            delete node;
+            worked = true;
+        }
+        if (pendingVoltage_.load() != CTL_NOVOLTAGE) {
+            applyVoltage(errcnt, errstr);
+            worked = true;
+        }
+        if (errcnt != 0) {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            errcnt_ += errcnt;
+            errstr_ += errstr;
+            errcnt = 0;
+            errstr.clear();
+        }
+        if (!worked) {
+            if (stop_) {  // The thread only stops once all pending work is done
+                break;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            sleeping_ = true;  // Producers only take the wake mutex if this flag is set, which is checked after their work is published
+            if (!hasWork() && !stop_) {
+                wakeCondition_.wait_for(lock, std::chrono::milliseconds(CTL_IDLEPERIOD));
+            }
+            sleeping_ = false;
+        }
+    }
+}
+
+// Private procedure that wakes up the I/O thread, if sleeping
+void FAU201Controller::wake()
+{
+    if (sleeping_) {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeCondition_.notify_one();
+    }
+}
+
+FAU201Controller::FAU201Controller(FAU201Device &device) :
+    device_(device),
+    stub_(),
+    head_(&stub_),
+    tail_(&stub_),
+    pendingVoltage_(CTL_NOVOLTAGE),
+    coalesced_(0),
+    running_(false),
+    stop_(false),
+    sleeping_(false),
+    thread_(),
+    wakeMutex_(),
+    wakeCondition_(),
+    errorMutex_(),
+    errcnt_(0),
+    errstr_()
+{
+    stub_.next.store(nullptr);
+}
+
+FAU201Controller::~FAU201Controller()
+{
+    stop();
+    Node *node;
+    while ((node = pop()) != nullptr) {  // Commands posted after stopping are discarded
+        delete node;
+    }
+}
+
+// Returns the number of voltages that were superseded by a newer one before being sent
+uint64_t FAU201Controller::coalescedVoltages() const
+{
+    return coalesced_;
+}
+
+// Checks if the I/O thread is running
+bool FAU201Controller::isRunning() const
+{
+    return running_;
+}
+
+// Appends to "errcnt" and "errstr" the errors reported by the I/O thread since the last call, clearing them afterwards
+void FAU201Controller::collectErrors(int &errcnt, std::string &errstr)
+{
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    errcnt += errcnt_;
+    errstr += errstr_;
+    errcnt_ = 0;
+    errstr_.clear();
+}
+
+// Blocks until every command posted and every voltage set before this call is carried out, which is useful before reading the device state
+// If the I/O thread is not running, this returns immediately
+void FAU201Controller::flush()
+{
+    if (running_) {
+        std::promise<void> done;
+        std::future<void> future = done.get_future();
+        post([this, &done](FAU201Device &, int &errcnt, std::string &errstr) {
+            applyVoltage(errcnt, errstr);  // The pending voltage may have been set before this command was posted, so it is applied right away
+            done.set_value();
+        });
+        future.wait();
+    }
+}
+
+// Queues a command to be executed by the I/O thread, without blocking
+// Commands are executed in the order they were posted, even if posted from different threads, provided that the calls do not overlap
+void FAU201Controller::post(const Command &command)
+{
+    Node *node = new Node;
+    node->command = command;
+    push(node);
+    wake();
+}
+
+// Sets the output voltage to the given value, without blocking
+// If the previous value was not sent yet, it is replaced, so that only the latest one is sent
+void FAU201Controller::setVoltage(float voltage, int &errcnt, std::string &errstr)
+{
+    if (voltage < FAU201Device::VOLTAGE_MIN || voltage > FAU201Device::VOLTAGE_MAX) {
+        ++errcnt;
+        errstr += "In setVoltage(): Voltage must be between 0 and 4.095.\n";  // Program logic error
+    } else {
+        uint32_t bits;
+        std::memcpy(&bits, &voltage, sizeof(bits));
+        if (pendingVoltage_.exchange(bits) != CTL_NOVOLTAGE) {
+            ++coalesced_;
+        }
+        wake();
+    }
+}
+
+// Starts the I/O thread, if not already running
+void FAU201Controller::start()
+{
+    if (!running_) {
+        stop_ = false;
+        running_ = true;
+        thread_ = std::thread(&FAU201Controller::run, this);
+    }
+}
+
+// Stops the I/O thread, if running, once all pending commands and voltages are carried out
+void FAU201Controller::stop()
+{
+    if (running_) {
+        stop_ = true;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeCondition_.notify_one();
+        }
+        thread_.join();
+        running_ = false;
+    }
+}
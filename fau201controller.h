@@ -0,0 +1,85 @@
+/* FAU201 controller class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef FAU201CONTROLLER_H
+#define FAU201CONTROLLER_H
+
+// Includes
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "fau201device.h"
+
+// Thread-safe front end to a FAU201 device, whose operations are carried out by a single I/O thread
+// Any number of threads can submit commands without blocking, via a lock-free queue, while voltage updates go through a single slot, so that only the latest pending value is sent
+// While the I/O thread is running, the device must not be accessed other than through this class
+class FAU201Controller
+{
+private:
+    struct Node {
+        std::function<void(FAU201Device &, int &, std::string &)> command;  // Command to be executed (see Command)
+        std::atomic<Node *> next;                                             // Next node in the queue
+    };
+
+    FAU201Device &device_;
+    Node stub_;
+    std::atomic<Node *> head_;
+    Node *tail_;
+    std::atomic<uint32_t> pendingVoltage_;
+    std::atomic<uint64_t> coalesced_;
+    std::atomic<bool> running_, stop_, sleeping_;
+    std::thread thread_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+    std::mutex errorMutex_;
+    int errcnt_;
+    std::string errstr_;
+
+    void applyVoltage(int &errcnt, std::string &errstr);
+    bool hasWork() const;
+    Node *pop();
+    void push(Node *node);
+    void run();
+    void wake();
+
+public:
+    // Command to be executed by the I/O thread, which receives the device and the error counter and string to be used in the process (see collectErrors())
+    typedef std::function<void(FAU201Device &device, int &errcnt, std::string &errstr)> Command;
+
+    explicit FAU201Controller(FAU201Device &device);
+    ~FAU201Controller();
+
+    uint64_t coalescedVoltages() const;
+    bool isRunning() const;
+
+    void collectErrors(int &errcnt, std::string &errstr);
+    void flush();
+    void post(const Command &command);
+    void setVoltage(float voltage, int &errcnt, std::string &errstr);
+    void start();
+    void stop();
+};
+
+#endif  // FAU201CONTROLLER_H
@@ -1,6 +1,6 @@
-/* FAU201 device class - Version 1.0.1
-   Requires CP2130 class version 1.1.0 or later
-   Copyright (c) 2022 Samuel Lourenço
+/* FAU201 device class - Version 1.1.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2022-2026 Samuel Lourenço
 
    This library is free software: you can redistribute it and/or modify it
    under the terms of the GNU Lesser General Public License as published by
@@ -20,16 +20,188 @@
 
 
 // Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 #include <unistd.h>
 #include <vector>
 #include "fau201device.h"
 
 // Definitions
-const uint8_t EPOUT = 0x01;  // Address of endpoint assuming the OUT direction
+// Specific to playSequence() (added in version 1.1.0)
+const size_t SEQ_FRAMESIZE = 11;           // Size of each frame, consisting of an 8-byte write command header followed by a 3-byte LTC2640 command
+const size_t SEQ_MAXFRAMES = 4096;         // Maximum number of frames sent per bulk transfer
+const unsigned int SEQ_CHUNKTIME = 250000;  // Maximum nominal duration of each bulk transfer, in microseconds (half of the transfer timeout)
+const unsigned int SEQ_FRAMEOVERHEAD = 18;  // Nominal duration of each frame, excluding the time taken to clock the 24 bits and any SPI delays, in microseconds
+
+// Specific to playRamp() and rampCodes() (added in version 1.1.0)
+const size_t RAMP_MAXSAMPLES = 4096;  // Number of samples above which playRamp() lowers the sample rate, in favor of longer intervals
+const double RAMP_EXPRATE = 5;        // Number of time constants covered by an exponential ramp, which then reaches over 99% of the way before being scaled to end exactly
+
+// Specific to diagnoseSettleDelay() (added in version 1.1.0)
+const uint16_t SETTLE_CANDIDATES[] = {FAU201Device::SETTLE_DELAY_DEFAULT, 50, 20, 10, 5, 2, 0};  // Settling delays tried, in microseconds, in descending order
+
+// Specific to saveSnapshot() and restoreSnapshot() (added in version 1.1.0)
+const uint8_t SNAP_MAGIC[4] = {'F', 'A', 'U', 'S'};  // Signature at the start of every snapshot
+const uint8_t SNAP_VERSION = 0x01;                   // Snapshot format version
+const size_t SNAP_FIXEDSIZE = 54;                    // Size of the fixed part of a snapshot, which is followed by the three descriptors
+
+// Specific to maxSampleRate() (added in version 1.1.0)
+const unsigned int FRAME_BITS = 24;  // Length of each LTC2640 command, in bits
+
+// Private procedure used to invalidate the cached identity of the device (added in version 1.1.0)
+void FAU201Device::invalidateIdentity()
+{
+    manufacturerCached_ = false;
+    productCached_ = false;
+    serialCached_ = false;
+    siliconVersionCached_ = false;
+    usbConfigCached_ = false;
+    pinConfigCached_ = false;
+}
+
+// Private function used to read a descriptor from the given snapshot, at the given index, which is then advanced past it (added in version 1.1.0)
+// Returns false if the descriptor extends beyond the end of the snapshot
+bool FAU201Device::readSnapshotString(const std::vector<uint8_t> &buffer, size_t &index, std::u16string &string)
+{
+    bool valid = index < buffer.size() && index + 1 + 2 * static_cast<size_t>(buffer[index]) <= buffer.size();
+    if (valid) {
+        size_t length = buffer[index];
+        string.resize(length);
+        for (size_t i = 0; i < length; ++i) {
+            string[i] = static_cast<char16_t>(buffer[index + 2 * i + 2] << 8 | buffer[index + 2 * i + 1]);  // Little-endian conversion
+        }
+        index += 1 + 2 * length;
+    }
+    return valid;
+}
+
+// Private procedure that waits for the chip select to settle, accounting for the time taken if statistics are enabled (added as a refactor in version 1.1.0)
+// The delay is taken according to the settling policy (see setSettlePolicy()), whereas it was a fixed 100us sleep up to version 1.0.1
+void FAU201Device::settle()
+{
+    if (settleMode_ != SETTLE_NONE) {
+        bool instrumented = cp2130_.isStatsEnabled();
+        std::chrono::steady_clock::time_point start;
+        if (instrumented || settleMode_ == SETTLE_BUSYWAIT) {
+            start = std::chrono::steady_clock::now();
+        }
+        if (settleMode_ == SETTLE_BUSYWAIT) {
+            std::chrono::steady_clock::time_point deadline = start + std::chrono::microseconds(settleDelay_);
+            while (std::chrono::steady_clock::now() < deadline) {
+                // Spin until the deadline is reached
+            }
+        } else {
+            usleep(settleDelay_);
+        }
+        if (instrumented) {
+            ++settles_;
+            settleTime_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+}
+
+// Private procedure used to append the given descriptor to a snapshot, as a length byte followed by the UTF-16 code units in little-endian format (added in version 1.1.0)
+void FAU201Device::writeSnapshotString(std::vector<uint8_t> &buffer, const std::u16string &string)
+{
+    size_t length = std::min(string.size(), static_cast<size_t>(0xff));  // Descriptors are never longer than 62 characters, so this is just a safeguard
+    buffer.push_back(static_cast<uint8_t>(length));
+    for (size_t i = 0; i < length; ++i) {
+        buffer.push_back(static_cast<uint8_t>(string[i]));
+        buffer.push_back(static_cast<uint8_t>(string[i] >> 8));
+    }
+}
+
+// "Equal to" operator for Frame
+bool FAU201Device::Frame::operator ==(const FAU201Device::Frame &other) const
+{
+    return bytes[0] == other.bytes[0] && bytes[1] == other.bytes[1] && bytes[2] == other.bytes[2];
+}
+
+// "Not equal to" operator for Frame
+bool FAU201Device::Frame::operator !=(const FAU201Device::Frame &other) const
+{
+    return !(operator ==(other));
+}
+
+// "Equal to" operator for Ramp
+bool FAU201Device::Ramp::operator ==(const FAU201Device::Ramp &other) const
+{
+    return start == other.start && end == other.end && duration == other.duration && shape == other.shape;
+}
+
+// "Not equal to" operator for Ramp
+bool FAU201Device::Ramp::operator !=(const FAU201Device::Ramp &other) const
+{
+    return !(operator ==(other));
+}
+
+// "Equal to" operator for SettleDiagnostic
+bool FAU201Device::SettleDiagnostic::operator ==(const FAU201Device::SettleDiagnostic &other) const
+{
+    return revision == other.revision && delay == other.delay && safe == other.safe;
+}
+
+// "Not equal to" operator for SettleDiagnostic
+bool FAU201Device::SettleDiagnostic::operator !=(const FAU201Device::SettleDiagnostic &other) const
+{
+    return !(operator ==(other));
+}
+
+// "Equal to" operator for SettlePolicy
+bool FAU201Device::SettlePolicy::operator ==(const FAU201Device::SettlePolicy &other) const
+{
+    return mode == other.mode && delay == other.delay;
+}
+
+// "Not equal to" operator for SettlePolicy
+bool FAU201Device::SettlePolicy::operator !=(const FAU201Device::SettlePolicy &other) const
+{
+    return !(operator ==(other));
+}
+
+// "Equal to" operator for Stats
+bool FAU201Device::Stats::operator ==(const FAU201Device::Stats &other) const
+{
+    return transfers == other.transfers && settles == other.settles && settleTime == other.settleTime;
+}
+
+// "Not equal to" operator for Stats
+bool FAU201Device::Stats::operator !=(const FAU201Device::Stats &other) const
+{
+    return !(operator ==(other));
+}
 
 FAU201Device::FAU201Device() :
-    cp2130_()
+    cp2130_(),
+    streaming_(false),
+    setUp_(false),
+    voltageKnown_(false),
+    voltage_(0),
+    codeKnown_(false),
+    code_(0x0000),
+    cfrq_(CP2130::CFRQ750K),
+    delays_(),
+    manufacturerCached_(false),
+    productCached_(false),
+    serialCached_(false),
+    siliconVersionCached_(false),
+    usbConfigCached_(false),
+    pinConfigCached_(false),
+    manufacturer_(),
+    product_(),
+    serial_(),
+    siliconVersion_(),
+    usbConfig_(),
+    pinConfig_(),
+    settles_(0),
+    settleTime_(0),
+    settleMode_(SETTLE_SLEEP),
+    settleDelay_(SETTLE_DELAY_DEFAULT)
 {
 }
 
@@ -45,16 +217,143 @@ bool FAU201Device::isOpen() const
     return cp2130_.isOpen();
 }
 
+// Checks if statistics are enabled (added in version 1.1.0)
+bool FAU201Device::isStatsEnabled() const
+{
+    return cp2130_.isStatsEnabled();
+}
+
+// Checks if the device is in streaming mode (added in version 1.1.0)
+bool FAU201Device::isStreaming() const
+{
+    return streaming_;
+}
+
+// Records, into the given batch, the operations required to set the output voltage to a given value (added in version 1.1.0)
+// The batch must be executed via executeBatch() afterwards. Note that, unlike setVoltage(), this does not affect the voltage that is restored by restore()
+void FAU201Device::appendVoltage(CP2130::Batch &batch, float voltage, int &errcnt, std::string &errstr)
+{
+    if (voltage < VOLTAGE_MIN || voltage > VOLTAGE_MAX) {
+        ++errcnt;
+        errstr += "In appendVoltage(): Voltage must be between 0 and 4.095.\n";  // Program logic error
+    } else {
+        if (!streaming_) {  // Otherwise, the chip select is already enabled (see setStreamingMode())
+            batch.selectCS(0, errcnt, errstr);  // Enable the chip select corresponding to channel 0, and disable any others
+            if (settleMode_ != SETTLE_NONE) {
+                batch.delay(settleDelay_);  // Wait for the chip select to settle, in order to prevent possible errors after enabling it (batch delays are always slept, irrespective of the settling mode)
+            }
+        }
+        Frame set = voltageFrame(voltage);  // Input and DAC registers updated to the given value
+        batch.spiWrite(set.bytes, sizeof(set.bytes), cp2130_.getEndpointOutAddr(errcnt, errstr));
+        if (!streaming_) {
+            if (settleMode_ != SETTLE_NONE) {
+                batch.delay(settleDelay_);  // Wait for the chip select to settle, in order to prevent possible errors while disabling it
+            }
+            batch.disableCS(0, errcnt, errstr);  // Disable the previously enabled chip select
+        }
+    }
+}
+
+// Returns the maximum sample rate, in hertz, that can be achieved by playSequence() given the clock frequency and SPI delays set by setup() (added in version 1.1.0)
+float FAU201Device::maxSampleRate() const
+{
+    return maxSampleRate(cfrq_, delays_);
+}
+
 // Closes the device safely, if open
 void FAU201Device::close()
 {
     cp2130_.close();
+    streaming_ = false;  // The chip select state is lost once the device is closed
+    codeKnown_ = false;  // Likewise, the DAC code is no longer known
+    setUp_ = false;
+    invalidateIdentity();  // Another device may be opened next
+}
+
+// Finds the minimum settling delay for which the device operates without failures, by busy-waiting for each of a set of decreasing delays (added in version 1.1.0)
+// For each delay, the current voltage is written the given number of times, and the search stops at the first delay for which any update fails
+// Since the DAC cannot be read back, only failed transfers are detected, so it is advisable to use a generous number of iterations, and to run this once per hardware revision
+// The output is left unchanged (or set to 0V, if no voltage was set before), as is the settling policy, and streaming mode must be disabled
+FAU201Device::SettleDiagnostic FAU201Device::diagnoseSettleDelay(uint16_t iterations, int &errcnt, std::string &errstr)
+{
+    SettleDiagnostic diagnostic;
+    diagnostic.delay = SETTLE_DELAY_DEFAULT;
+    diagnostic.safe = false;
+    if (iterations == 0) {
+        ++errcnt;
+        errstr += "In diagnoseSettleDelay(): Number of iterations must be greater than zero.\n";  // Program logic error
+    } else if (streaming_) {
+        ++errcnt;
+        errstr += "In diagnoseSettleDelay(): Streaming mode must be disabled.\n";  // Program logic error
+    } else {
+        int preverrcnt = errcnt;
+        diagnostic.revision = getHardwareRevision(errcnt, errstr);
+        if (errcnt == preverrcnt) {
+            uint8_t mode = settleMode_;
+            uint16_t delay = settleDelay_;
+            uint16_t code = voltageKnown_ ? voltageCode(voltage_) : 0x0000;
+            for (size_t i = 0; i < sizeof(SETTLE_CANDIDATES) / sizeof(SETTLE_CANDIDATES[0]); ++i) {
+                settleMode_ = SETTLE_CANDIDATES[i] == 0 ? SETTLE_NONE : SETTLE_BUSYWAIT;
+                settleDelay_ = SETTLE_CANDIDATES[i];
+                bool failed = false;
+                for (uint16_t j = 0; j < iterations && !failed; ++j) {
+                    failed = setVoltageCode(code, true).code != CP2130::STATUS_OK;  // Forced, so that the chip select is set every time
+                }
+                if (failed) {
+                    break;
+                }
+                diagnostic.delay = SETTLE_CANDIDATES[i];
+                diagnostic.safe = true;
+            }
+            settleMode_ = mode;
+            settleDelay_ = delay;
+            setVoltageCode(code, true, errcnt, errstr);  // Leave the DAC in a known state, using the original settling policy
+        }
+    }
+    return diagnostic;
+}
+
+// Disables statistics, keeping the ones gathered so far (added in version 1.1.0)
+void FAU201Device::disableStats()
+{
+    cp2130_.disableStats();
+}
+
+// Enables statistics regarding transfers and settling delays, which can be retrieved using getStats() (added in version 1.1.0)
+void FAU201Device::enableStats()
+{
+    cp2130_.enableStats();
+}
+
+// Executes the given batch of operations on the CP2130 bridge (added in version 1.1.0)
+// See CP2130::executeBatch() for details
+void FAU201Device::executeBatch(const CP2130::Batch &batch, int &errcnt, std::string &errstr)
+{
+    codeKnown_ = false;  // The batch may update the DAC (see appendVoltage())
+    cp2130_.executeBatch(batch, errcnt, errstr);
 }
 
 // Returns the silicon version of the CP2130 bridge
+// Since version 1.1.0, this value is cached after being successfully retrieved (see refresh())
 CP2130::SiliconVersion FAU201Device::getCP2130SiliconVersion(int &errcnt, std::string &errstr)
 {
-    return cp2130_.getSiliconVersion(errcnt, errstr);
+    if (!siliconVersionCached_) {
+        int preverrcnt = errcnt;
+        siliconVersion_ = cp2130_.getSiliconVersion(errcnt, errstr);
+        siliconVersionCached_ = errcnt == preverrcnt;
+    }
+    return siliconVersion_;
+}
+
+// Gets the pin configuration of the CP2130, which is cached after the first successful read (added in version 1.1.0)
+CP2130::PinConfig FAU201Device::getCP2130PinConfig(int &errcnt, std::string &errstr)
+{
+    if (!pinConfigCached_) {
+        int preverrcnt = errcnt;
+        pinConfig_ = cp2130_.getPinConfig(errcnt, errstr);
+        pinConfigCached_ = errcnt == preverrcnt;
+    }
+    return pinConfig_;
 }
 
 // Returns the hardware revision of the device
@@ -64,80 +363,768 @@ std::string FAU201Device::getHardwareRevision(int &errcnt, std::string &errstr)
 }
 
 // Gets the manufacturer descriptor from the device
+// Since version 1.1.0, the descriptor is cached after being successfully retrieved (see refresh())
 std::u16string FAU201Device::getManufacturerDesc(int &errcnt, std::string &errstr)
 {
-    return cp2130_.getManufacturerDesc(errcnt, errstr);
+    if (!manufacturerCached_) {
+        int preverrcnt = errcnt;
+        cp2130_.getManufacturerDesc(manufacturer_, errcnt, errstr);  // Since version 1.1.0, the cached string is reused
+        manufacturerCached_ = errcnt == preverrcnt;
+    }
+    return manufacturer_;
 }
 
 // Gets the product descriptor from the device
+// Since version 1.1.0, the descriptor is cached after being successfully retrieved (see refresh())
 std::u16string FAU201Device::getProductDesc(int &errcnt, std::string &errstr)
 {
-    return cp2130_.getProductDesc(errcnt, errstr);
+    if (!productCached_) {
+        int preverrcnt = errcnt;
+        cp2130_.getProductDesc(product_, errcnt, errstr);
+        productCached_ = errcnt == preverrcnt;
+    }
+    return product_;
 }
 
 // Gets the serial descriptor from the device
+// Since version 1.1.0, the descriptor is cached after being successfully retrieved (see refresh())
 std::u16string FAU201Device::getSerialDesc(int &errcnt, std::string &errstr)
 {
-    return cp2130_.getSerialDesc(errcnt, errstr);
+    if (!serialCached_) {
+        int preverrcnt = errcnt;
+        cp2130_.getSerialDesc(serial_, errcnt, errstr);
+        serialCached_ = errcnt == preverrcnt;
+    }
+    return serial_;
+}
+
+// Returns the current settling policy (added in version 1.1.0)
+FAU201Device::SettlePolicy FAU201Device::getSettlePolicy() const
+{
+    SettlePolicy policy;
+    policy.mode = settleMode_;
+    policy.delay = settleDelay_;
+    return policy;
+}
+
+// Returns a snapshot of the statistics gathered so far (added in version 1.1.0)
+FAU201Device::Stats FAU201Device::getStats() const
+{
+    Stats stats;
+    stats.transfers = cp2130_.getStats();
+    stats.settles = settles_;
+    stats.settleTime = settleTime_;
+    return stats;
+}
+
+// Gets the timeout and retry policy of the given transfer class of the underlying CP2130 (see CP2130::getTransferPolicy() - added in version 1.1.0)
+CP2130::TransferPolicy FAU201Device::getTransferPolicy(uint8_t transferClass, int &errcnt, std::string &errstr) const
+{
+    return cp2130_.getTransferPolicy(transferClass, errcnt, errstr);
 }
 
 // Gets the USB configuration of the device
+// Since version 1.1.0, the configuration is cached after being successfully retrieved (see refresh())
 CP2130::USBConfig FAU201Device::getUSBConfig(int &errcnt, std::string &errstr)
 {
-    return cp2130_.getUSBConfig(errcnt, errstr);
+    if (!usbConfigCached_) {
+        int preverrcnt = errcnt;
+        usbConfig_ = cp2130_.getUSBConfig(errcnt, errstr);
+        usbConfigCached_ = errcnt == preverrcnt;
+    }
+    return usbConfig_;
 }
 
 // Opens a device and assigns its handle
 int FAU201Device::open(const std::string &serial)
 {
+    if (!isOpen()) {
+        invalidateIdentity();
+    }
     return cp2130_.open(VID, PID, serial);
 }
 
+// Opens a device using the given libusb context, and assigns its handle (added in version 1.1.0)
+// See CP2130::open() for details regarding shared contexts
+int FAU201Device::open(libusb_context *context, const std::string &serial)
+{
+    if (!isOpen()) {
+        invalidateIdentity();
+    }
+    return cp2130_.open(context, VID, PID, serial);
+}
+
+// Opens the device described by the given record, as returned by enumerateDevices() (added in version 1.1.0)
+int FAU201Device::open(const CP2130::DeviceRecord &record)
+{
+    if (!isOpen()) {
+        invalidateIdentity();
+    }
+    return cp2130_.open(record);
+}
+
+// Opens the device described by the given record, using the given libusb context (added in version 1.1.0)
+int FAU201Device::open(libusb_context *context, const CP2130::DeviceRecord &record)
+{
+    if (!isOpen()) {
+        invalidateIdentity();
+    }
+    return cp2130_.open(context, record);
+}
+
+// Opens a device through the given transport, such as CP2130Simulator (added in version 1.1.0)
+// See CP2130::open(USBTransport *) for details
+int FAU201Device::open(USBTransport *transport)
+{
+    if (!isOpen()) {
+        invalidateIdentity();
+    }
+    return cp2130_.open(transport);
+}
+
+// Plays the given ramp, paced by the CP2130 itself (added in version 1.1.0)
+// The sample interval is chosen so that the ramp is played at the maximum sample rate (see maxSampleRate()), using up to 4096 samples, or more if the ramp is too long for the maximum interval
+// The codes are precomputed by rampCodes(), and then played by playSequence(), which blocks for the duration of the ramp
+void FAU201Device::playRamp(const Ramp &ramp, int &errcnt, std::string &errstr)
+{
+    if (ramp.duration.count() <= 0) {
+        ++errcnt;
+        errstr += "In playRamp(): Duration must be greater than zero.\n";  // Program logic error
+    } else {
+        CP2130::SPIDelays delays = delays_;  // As in playSequence(), the post-assert delay is not part of the frame
+        delays.pstasten = false;
+        double frameTime = 1000000 / maxSampleRate(cfrq_, delays);  // Duration of each frame, in microseconds
+        double duration = static_cast<double>(ramp.duration.count());
+        double period = std::min(std::max(frameTime, duration / RAMP_MAXSAMPLES), frameTime + 10.0 * INTERVAL_MAX);  // Intended sample period, in microseconds
+        uint16_t interval = static_cast<uint16_t>((period - frameTime) / 10 + 0.5);
+        size_t steps = static_cast<size_t>(duration / (frameTime + 10.0 * interval) + 0.5) + 1;  // Both the start and end voltages are included
+        std::vector<uint16_t> codes = rampCodes(ramp, std::max(steps, static_cast<size_t>(2)), errcnt, errstr);
+        std::vector<Frame> frames(codes.size());
+        for (size_t i = 0; i < codes.size(); ++i) {
+            frames[i] = codeFrame(codes[i]);
+        }
+        playSequence(frames, interval, errcnt, errstr);  // Nothing is played if the codes could not be computed
+    }
+}
+
+// Plays a sequence of voltages, paced by the CP2130 itself (added in version 1.1.0)
+// Each voltage is sent as a separate SPI write command, so that the chip select is deasserted between frames, and the DAC is updated on each rising edge
+// The frames are packed into as few bulk transfers as possible, while the post-assert delay of channel 0 is set to the given interval (10us units)
+// Thus, the effective sample interval is the given interval plus the duration of each frame (about 50us at 750KHz - see maxSampleRate())
+// The voltages are converted to frames before being played by the next function, which is better suited to waveforms that are played repeatedly
+void FAU201Device::playSequence(const std::vector<float> &voltages, uint16_t interval, int &errcnt, std::string &errstr)
+{
+    bool valid = true;
+    for (size_t i = 0; i < voltages.size(); ++i) {
+        if (voltages[i] < VOLTAGE_MIN || voltages[i] > VOLTAGE_MAX) {
+            valid = false;
+            break;
+        }
+    }
+    if (!valid) {
+        ++errcnt;
+        errstr += "In playSequence(): Voltages must be between 0 and 4.095.\n";  // Program logic error
+    } else {
+        std::vector<Frame> frames(voltages.size());
+        for (size_t i = 0; i < voltages.size(); ++i) {
+            frames[i] = voltageFrame(voltages[i]);
+        }
+        playSequence(frames, interval, errcnt, errstr);
+    }
+}
+
+// Plays a sequence of precomputed frames, as returned by codeFrame() or voltageFrame(), paced by the CP2130 itself (added in version 1.1.0)
+// Since the frames are known to be valid by construction, they are copied as they are, with no per-sample arithmetic or validation
+// See the previous function for details
+void FAU201Device::playSequence(const std::vector<Frame> &frames, uint16_t interval, int &errcnt, std::string &errstr)
+{
+    if (interval > INTERVAL_MAX) {
+        ++errcnt;
+        errstr += "In playSequence(): Interval must not be greater than 25000.\n";  // Program logic error
+    } else if (!frames.empty()) {
+        int preverrcnt = errcnt;
+        codeKnown_ = false;  // Unless the whole sequence is played, the DAC code is not known
+        CP2130::SPIDelays delays = delays_;  // The delays set by setup() are kept, except for the post-assert delay
+        delays.pstasten = interval != 0;  // Post-assert delay enabled, as long as an interval is specified
+        delays.pstastdly = interval;  // Post-assert delay set to the given interval
+        cp2130_.configureSPIDelays(0, delays, errcnt, errstr);  // Apply the above delays to channel 0
+        delays.pstasten = false;
+        unsigned int frameTime = static_cast<unsigned int>(1000000 / maxSampleRate(cfrq_, delays) + 0.5);  // Duration of each frame, excluding the post-assert delay, in microseconds
+        if (!streaming_) {
+            cp2130_.selectCS(0, errcnt, errstr);  // Enable the chip select corresponding to channel 0, and disable any others
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors after enabling it (see setVoltage())
+        }
+        size_t framesPerTransfer = SEQ_CHUNKTIME / (10 * interval + frameTime);
+        if (framesPerTransfer < 1) {
+            framesPerTransfer = 1;
+        } else if (framesPerTransfer > SEQ_MAXFRAMES) {
+            framesPerTransfer = SEQ_MAXFRAMES;
+        }
+        uint8_t endpointOutAddr = cp2130_.getEndpointOutAddr(errcnt, errstr);
+        size_t nframes = frames.size();
+        size_t framesProcessed = 0;
+        std::vector<unsigned char> buffer(SEQ_FRAMESIZE * (nframes < framesPerTransfer ? nframes : framesPerTransfer));
+        while (framesProcessed < nframes && preverrcnt == errcnt) {  // The loop is interrupted in case of error
+            size_t framesRemaining = nframes - framesProcessed;
+            size_t framesInTransfer = framesRemaining > framesPerTransfer ? framesPerTransfer : framesRemaining;
+            for (size_t i = 0; i < framesInTransfer; ++i) {
+                const Frame &source = frames[framesProcessed + i];
+                unsigned char *frame = &buffer[SEQ_FRAMESIZE * i];
+                frame[0] = 0x00;                                     // Reserved
+                frame[1] = 0x00;                                     // Reserved
+                frame[2] = CP2130::WRITE;                            // Write command
+                frame[3] = 0x00;                                     // Reserved
+                frame[4] = 0x03;                                     // Three bytes to write
+                frame[5] = 0x00;
+                frame[6] = 0x00;
+                frame[7] = 0x00;
+                frame[8] = source.bytes[0];                          // LTC2640 command (see codeFrame())
+                frame[9] = source.bytes[1];
+                frame[10] = source.bytes[2];
+            }
+            int bytesWritten;
+            cp2130_.bulkTransfer(endpointOutAddr, buffer.data(), static_cast<int>(SEQ_FRAMESIZE * framesInTransfer), &bytesWritten, errcnt, errstr);
+            framesProcessed += framesInTransfer;
+        }
+        if (!streaming_) {
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors while disabling it (see setVoltage())
+            cp2130_.disableCS(0, errcnt, errstr);  // Disable the previously enabled chip select
+        }
+        cp2130_.configureSPIDelays(0, delays_, errcnt, errstr);  // Restore the SPI delays set by setup()
+        if (errcnt == preverrcnt) {
+            codeKnown_ = true;
+            code_ = static_cast<uint16_t>(frames.back().bytes[1] << 4 | frames.back().bytes[2] >> 4);  // The output is left at the last voltage of the sequence (see restore())
+            voltageKnown_ = true;
+            voltage_ = static_cast<float>(code_) / 1000;
+        }
+    }
+}
+
+// Discards the cached identity of the device, namely its descriptors, USB configuration, pin configuration and silicon version, and then reads it again (added in version 1.1.0)
+void FAU201Device::refresh(int &errcnt, std::string &errstr)
+{
+    invalidateIdentity();
+    getManufacturerDesc(errcnt, errstr);
+    getProductDesc(errcnt, errstr);
+    getSerialDesc(errcnt, errstr);
+    getCP2130SiliconVersion(errcnt, errstr);
+    getUSBConfig(errcnt, errstr);
+    getCP2130PinConfig(errcnt, errstr);
+}
+
 // Issues a reset to the CP2130, which in effect resets the entire device
 void FAU201Device::reset(int &errcnt, std::string &errstr)
 {
+    codeKnown_ = false;  // The device is expected to reenumerate, and a reset may be followed by a power cycle
+    setUp_ = false;
     cp2130_.reset(errcnt, errstr);
 }
 
+// Clears the statistics gathered so far (added in version 1.1.0)
+void FAU201Device::resetStats()
+{
+    cp2130_.resetStats();
+    settles_ = 0;
+    settleTime_ = 0;
+}
+
+// Sets up the device again and then sets the output voltage to the last value that was set, if any (added in version 1.1.0)
+// This is intended to be used after reopening a device that was disconnected, since the last voltage is kept when the device is closed
+void FAU201Device::restore(int &errcnt, std::string &errstr)
+{
+    setup(cfrq_, delays_, errcnt, errstr);  // The clock frequency and SPI delays that were set before are reused
+    if (voltageKnown_) {
+        setVoltage(voltage_, true, errcnt, errstr);  // Forced, since the DAC may have lost its contents
+    }
+}
+
+// Restores the state of the device from the snapshot saved to the given file by saveSnapshot(), returning true if no reconfiguration was needed (added in version 1.1.0)
+// The snapshot is first checked against the USB configuration of the device, which must match, and then the SPI mode of channel 0 is compared to the one set by setup()
+// If the SPI mode matches, the device is assumed to have kept its configuration, and the cached state is adopted as is, thus costing two control transfers, besides the one made by open()
+// Otherwise, the device is set up again and the last voltage is restored, as in restore(), in which case the cached identity is still adopted
+// Either way, snapshots should be kept per serial number, since the USB configuration does not tell apart devices of the same revision
+bool FAU201Device::restoreSnapshot(const std::string &path, int &errcnt, std::string &errstr)
+{
+    bool warm = false;
+    if (!cp2130_.isOpen()) {
+        ++errcnt;
+        errstr += "In restoreSnapshot(): device is not open.\n";  // Program logic error
+    } else {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        std::vector<uint8_t> buffer;
+        if (file) {
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        if (!file && !file.eof()) {
+            ++errcnt;
+            errstr += "Could not read snapshot from \"" + path + "\".\n";
+        } else {
+            std::u16string manufacturer, product, serial;
+            size_t index = SNAP_FIXEDSIZE;
+            bool valid = buffer.size() >= SNAP_FIXEDSIZE && std::equal(SNAP_MAGIC, SNAP_MAGIC + sizeof(SNAP_MAGIC), buffer.begin()) && buffer[4] == SNAP_VERSION &&
+                         readSnapshotString(buffer, index, manufacturer) && readSnapshotString(buffer, index, product) && readSnapshotString(buffer, index, serial) && index == buffer.size();
+            uint8_t cfrq = 0x00;
+            CP2130::SPIDelays delays = {false, false, false, false, 0x0000, 0x0000, 0x0000};
+            uint16_t code = 0x0000;
+            float voltage = 0;
+            CP2130::SiliconVersion siliconVersion;
+            CP2130::USBConfig usbConfig;
+            CP2130::PinConfig pinConfig;
+            if (valid) {
+                cfrq = buffer[5];
+                delays.cstglen = (0x01 & buffer[6]) != 0x00;
+                delays.prdasten = (0x02 & buffer[6]) != 0x00;
+                delays.pstasten = (0x04 & buffer[6]) != 0x00;
+                delays.itbyten = (0x08 & buffer[6]) != 0x00;
+                delays.prdastdly = static_cast<uint16_t>(buffer[8] << 8 | buffer[7]);  // Multi-byte values are stored in little-endian format
+                delays.pstastdly = static_cast<uint16_t>(buffer[10] << 8 | buffer[9]);
+                delays.itbytdly = static_cast<uint16_t>(buffer[12] << 8 | buffer[11]);
+                code = static_cast<uint16_t>(buffer[15] << 8 | buffer[14]);
+                uint32_t voltageBits = static_cast<uint32_t>(buffer[19]) << 24 | static_cast<uint32_t>(buffer[18] << 16 | buffer[17] << 8 | buffer[16]);
+                std::memcpy(&voltage, &voltageBits, sizeof(voltage));
+                siliconVersion.maj = buffer[23];
+                siliconVersion.min = buffer[24];
+                usbConfig.vid = static_cast<uint16_t>(buffer[26] << 8 | buffer[25]);
+                usbConfig.pid = static_cast<uint16_t>(buffer[28] << 8 | buffer[27]);
+                usbConfig.majrel = buffer[29];
+                usbConfig.minrel = buffer[30];
+                usbConfig.maxpow = buffer[31];
+                usbConfig.powmode = buffer[32];
+                usbConfig.trfprio = buffer[33];
+                pinConfig.gpio0 = buffer[34];
+                pinConfig.gpio1 = buffer[35];
+                pinConfig.gpio2 = buffer[36];
+                pinConfig.gpio3 = buffer[37];
+                pinConfig.gpio4 = buffer[38];
+                pinConfig.gpio5 = buffer[39];
+                pinConfig.gpio6 = buffer[40];
+                pinConfig.gpio7 = buffer[41];
+                pinConfig.gpio8 = buffer[42];
+                pinConfig.gpio9 = buffer[43];
+                pinConfig.gpio10 = buffer[44];
+                pinConfig.sspndlvl = static_cast<uint16_t>(buffer[46] << 8 | buffer[45]);
+                pinConfig.sspndmode = static_cast<uint16_t>(buffer[48] << 8 | buffer[47]);
+                pinConfig.wkupmask = static_cast<uint16_t>(buffer[50] << 8 | buffer[49]);
+                pinConfig.wkupmatch = static_cast<uint16_t>(buffer[52] << 8 | buffer[51]);
+                pinConfig.divider = buffer[53];
+                uint16_t settleDelay = static_cast<uint16_t>(buffer[22] << 8 | buffer[21]);
+                valid = cfrq <= CFRQ_LAST && !delays.cstglen && code <= CODE_MAX && ((0x02 & buffer[13]) == 0x00 || (voltage >= VOLTAGE_MIN && voltage <= VOLTAGE_MAX)) &&
+                        (buffer[20] == SETTLE_NONE || buffer[20] == SETTLE_SLEEP || (buffer[20] == SETTLE_BUSYWAIT && settleDelay <= SETTLE_BUSYWAIT_MAX));  // Same checks as in setup(), setVoltage() and setSettlePolicy()
+            }
+            int preverrcnt = errcnt;
+            if (!valid) {
+                ++errcnt;
+                errstr += "Invalid snapshot \"" + path + "\".\n";
+            } else {
+                CP2130::USBConfig deviceUSBConfig = cp2130_.getUSBConfig(errcnt, errstr);  // A single control transfer, since the OTP ROM is not read as a whole for this (see CP2130::getUSBConfig())
+                if (errcnt == preverrcnt && deviceUSBConfig != usbConfig) {
+                    ++errcnt;
+                    errstr += "Snapshot \"" + path + "\" does not match the device.\n";
+                }
+            }
+            if (errcnt == preverrcnt) {
+                manufacturer_ = manufacturer;  // The identity of the device is kept in its OTP ROM, so it is adopted either way
+                product_ = product;
+                serial_ = serial;
+                siliconVersion_ = siliconVersion;
+                usbConfig_ = usbConfig;
+                pinConfig_ = pinConfig;
+                manufacturerCached_ = true;
+                productCached_ = true;
+                serialCached_ = true;
+                siliconVersionCached_ = true;
+                usbConfigCached_ = true;
+                pinConfigCached_ = true;
+                settleMode_ = buffer[20];
+                settleDelay_ = static_cast<uint16_t>(buffer[22] << 8 | buffer[21]);
+                CP2130::SPIMode expected;
+                expected.csmode = CP2130::CSMODEPP;  // As set by setup()
+                expected.cfrq = cfrq;
+                expected.cpol = CP2130::CPOL0;
+                expected.cpha = CP2130::CPHA0;
+                CP2130::SPIMode mode = cp2130_.getSPIMode(0, errcnt, errstr);
+                cfrq_ = cfrq;
+                delays_ = delays;
+                voltageKnown_ = (0x02 & buffer[13]) != 0x00;
+                voltage_ = voltage;
+                if (errcnt == preverrcnt && mode == expected) {
+                    codeKnown_ = (0x01 & buffer[13]) != 0x00;
+                    code_ = code;
+                    setUp_ = true;
+                    warm = true;
+                } else if (errcnt == preverrcnt) {
+                    restore(errcnt, errstr);  // The device lost its configuration, possibly due to a power cycle
+                }
+            }
+        }
+    }
+    return warm;
+}
+
+// Saves the state of the device to the given file, so that it can be restored by restoreSnapshot() after reopening the device, even from another process (added in version 1.1.0)
+// The snapshot contains the clock frequency and SPI delays set by setup(), the last voltage and DAC code, the settling policy, the descriptors, and the silicon version, USB configuration and pin configuration of the CP2130
+// The device must be set up, and any parts of its identity that are not cached yet are read first, so it is best to save snapshots right before closing
+// The file is written under a temporary name, and then renamed, so that an existing snapshot is never left truncated
+void FAU201Device::saveSnapshot(const std::string &path, int &errcnt, std::string &errstr)
+{
+    if (!setUp_) {
+        ++errcnt;
+        errstr += "In saveSnapshot(): Device is not set up.\n";  // Program logic error
+    } else {
+        int preverrcnt = errcnt;
+        std::u16string manufacturer = getManufacturerDesc(errcnt, errstr);
+        std::u16string product = getProductDesc(errcnt, errstr);
+        std::u16string serial = getSerialDesc(errcnt, errstr);
+        CP2130::SiliconVersion siliconVersion = getCP2130SiliconVersion(errcnt, errstr);
+        CP2130::USBConfig usbConfig = getUSBConfig(errcnt, errstr);
+        CP2130::PinConfig pinConfig = getCP2130PinConfig(errcnt, errstr);
+        if (errcnt == preverrcnt) {
+            uint32_t voltageBits;
+            std::memcpy(&voltageBits, &voltage_, sizeof(voltageBits));
+            std::vector<uint8_t> buffer = {
+                SNAP_MAGIC[0], SNAP_MAGIC[1], SNAP_MAGIC[2], SNAP_MAGIC[3],  // Signature
+                SNAP_VERSION,                                                 // Format version
+                cfrq_,                                                        // Clock frequency
+                static_cast<uint8_t>((delays_.cstglen ? 0x01 : 0x00) | (delays_.prdasten ? 0x02 : 0x00) | (delays_.pstasten ? 0x04 : 0x00) | (delays_.itbyten ? 0x08 : 0x00)),
+                static_cast<uint8_t>(delays_.prdastdly), static_cast<uint8_t>(delays_.prdastdly >> 8),
+                static_cast<uint8_t>(delays_.pstastdly), static_cast<uint8_t>(delays_.pstastdly >> 8),
+                static_cast<uint8_t>(delays_.itbytdly), static_cast<uint8_t>(delays_.itbytdly >> 8),
+                static_cast<uint8_t>((codeKnown_ ? 0x01 : 0x00) | (voltageKnown_ ? 0x02 : 0x00)),
+                static_cast<uint8_t>(code_), static_cast<uint8_t>(code_ >> 8),
+                static_cast<uint8_t>(voltageBits), static_cast<uint8_t>(voltageBits >> 8), static_cast<uint8_t>(voltageBits >> 16), static_cast<uint8_t>(voltageBits >> 24),
+                settleMode_,
+                static_cast<uint8_t>(settleDelay_), static_cast<uint8_t>(settleDelay_ >> 8),
+                siliconVersion.maj, siliconVersion.min,
+                static_cast<uint8_t>(usbConfig.vid), static_cast<uint8_t>(usbConfig.vid >> 8),
+                static_cast<uint8_t>(usbConfig.pid), static_cast<uint8_t>(usbConfig.pid >> 8),
+                usbConfig.majrel, usbConfig.minrel, usbConfig.maxpow, usbConfig.powmode, usbConfig.trfprio,
+                pinConfig.gpio0, pinConfig.gpio1, pinConfig.gpio2, pinConfig.gpio3, pinConfig.gpio4, pinConfig.gpio5,
+                pinConfig.gpio6, pinConfig.gpio7, pinConfig.gpio8, pinConfig.gpio9, pinConfig.gpio10,
+                static_cast<uint8_t>(pinConfig.sspndlvl), static_cast<uint8_t>(pinConfig.sspndlvl >> 8),
+                static_cast<uint8_t>(pinConfig.sspndmode), static_cast<uint8_t>(pinConfig.sspndmode >> 8),
+                static_cast<uint8_t>(pinConfig.wkupmask), static_cast<uint8_t>(pinConfig.wkupmask >> 8),
+                static_cast<uint8_t>(pinConfig.wkupmatch), static_cast<uint8_t>(pinConfig.wkupmatch >> 8),
+                pinConfig.divider
+            };
+            writeSnapshotString(buffer, manufacturer);
+            writeSnapshotString(buffer, product);
+            writeSnapshotString(buffer, serial);
+            std::string temporaryPath = path + ".tmp";
+            std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            file.close();
+            if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+                std::remove(temporaryPath.c_str());
+                ++errcnt;
+                errstr += "Could not write snapshot to \"" + path + "\".\n";
+            }
+        }
+    }
+}
+
+// Sets the output voltage to a given value in millivolts, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.1.0)
+// Since each code step of the DAC corresponds to 1mV, this is equivalent to setVoltageCode(uint16_t, bool), except for the error reported
+CP2130::Status FAU201Device::setMillivolts(uint16_t millivolts, bool force)
+{
+    CP2130::Status status = {CP2130::STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (millivolts > MILLIVOLTS_MAX) {
+        status.code = CP2130::STATUS_INVALID_ARGUMENT;  // Program logic error
+        status.function = "setMillivolts";
+        status.detail = "Voltage must be between 0 and 4095 millivolts.";
+    } else {
+        status = setVoltageCode(millivolts, force);
+    }
+    return status;
+}
+
+// Sets the output voltage to a given value in millivolts (added in version 1.1.0)
+void FAU201Device::setMillivolts(uint16_t millivolts, int &errcnt, std::string &errstr)
+{
+    if (millivolts > MILLIVOLTS_MAX) {
+        ++errcnt;
+        errstr += "In setMillivolts(): Voltage must be between 0 and 4095 millivolts.\n";  // Program logic error
+    } else {
+        setVoltageCode(millivolts, errcnt, errstr);
+    }
+}
+
+// Sets the settling policy, which determines how the delays around each change of the chip select are taken (added in version 1.1.0)
+// SETTLE_NONE is intended to be used when the chip select timing is handled by the CP2130 itself, by enabling the post-assert and pre-deassert delays (see setup())
+// SETTLE_BUSYWAIT is suitable for short delays, up to SETTLE_BUSYWAIT_MAX, while SETTLE_SLEEP with the default delay corresponds to the behavior up to version 1.0.1
+// See diagnoseSettleDelay() on how to find the minimum delay for a given board
+void FAU201Device::setSettlePolicy(const SettlePolicy &policy, int &errcnt, std::string &errstr)
+{
+    if (policy.mode != SETTLE_NONE && policy.mode != SETTLE_BUSYWAIT && policy.mode != SETTLE_SLEEP) {
+        ++errcnt;
+        errstr += "In setSettlePolicy(): Mode must be SETTLE_NONE, SETTLE_BUSYWAIT or SETTLE_SLEEP.\n";  // Program logic error
+    } else if (policy.mode == SETTLE_BUSYWAIT && policy.delay > SETTLE_BUSYWAIT_MAX) {
+        ++errcnt;
+        errstr += "In setSettlePolicy(): Delay must not be greater than 1000us when busy-waiting.\n";  // Program logic error
+    } else {
+        settleMode_ = policy.mode;
+        settleDelay_ = policy.delay;
+    }
+}
+
+// Enables or disables streaming mode (added in version 1.1.0)
+// In streaming mode, the chip select corresponding to channel 0 is kept enabled, so that the CP2130 asserts it automatically for the duration of each SPI transfer
+// As a result, each call to setVoltage() costs a single bulk OUT transfer, instead of two control transfers, one bulk transfer and two settling delays
+// This raises the achievable update rate from a few hundred updates per second to about one or two thousand, depending on the host controller
+void FAU201Device::setStreamingMode(bool enable, int &errcnt, std::string &errstr)
+{
+    if (enable != streaming_) {
+        int preverrcnt = errcnt;
+        if (enable) {
+            cp2130_.selectCS(0, errcnt, errstr);  // Enable the chip select corresponding to channel 0, and disable any others
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors after enabling it (see setVoltage())
+        } else {
+            cp2130_.disableCS(0, errcnt, errstr);  // Disable the previously enabled chip select
+        }
+        if (errcnt == preverrcnt) {  // The mode is only changed if the chip select was set accordingly, since updates would otherwise skip selecting it
+            streaming_ = enable;
+        }
+    }
+}
+
+// Sets the timeout and retry policy of the given transfer class of the underlying CP2130 (see CP2130::setTransferPolicy() - added in version 1.1.0)
+// DAC updates are bulk transfers (CP2130::TRANSFERS_BULK), so a short timeout and no retries make a realtime loop fail fast instead of stalling
+void FAU201Device::setTransferPolicy(uint8_t transferClass, const CP2130::TransferPolicy &policy, int &errcnt, std::string &errstr)
+{
+    cp2130_.setTransferPolicy(transferClass, policy, errcnt, errstr);
+}
+
 // Sets up and prepares the device
+// Since version 1.1.0, this is equivalent to calling the next function with a clock frequency of 750KHz and all SPI delays disabled
 void FAU201Device::setup(int &errcnt, std::string &errstr)
 {
-    CP2130::SPIMode mode;
-    mode.csmode = CP2130::CSMODEPP;  // Chip select pin mode regarding channel 0 is push-pull
-    mode.cfrq = CP2130::CFRQ750K;  // SPI clock frequency set to 750KHz
-    mode.cpol = CP2130::CPOL0;  // SPI clock polarity is active high (CPOL = 0)
-    mode.cpha = CP2130::CPHA0;  // SPI data is valid on each rising edge (CPHA = 0)
-    cp2130_.configureSPIMode(0, mode, errcnt, errstr);  // Configure SPI mode for channel 0, using the above settings
-    cp2130_.disableSPIDelays(0, errcnt, errstr);  // Disable all SPI delays for channel 0
-    cp2130_.selectCS(0, errcnt, errstr);  // Enable the chip select corresponding to channel 0, and disable any others
-    usleep(100);  // Wait 100us, in order to prevent possible errors after enabling the chip select (workaround implemented in version 1.0.1)
-    std::vector<uint8_t> config = {0x70, 0x00, 0x00};  // Use external voltage reference
-    cp2130_.spiWrite(config, EPOUT, errcnt, errstr);  // Send the the configuration above to the LTC2640 DAC
-    usleep(100);  // Wait 100us, in order to prevent possible errors while disabling the chip select (workaround)
-    cp2130_.disableCS(0, errcnt, errstr);  // Disable the previously enabled chip select
+    CP2130::SPIDelays delays = {false, false, false, false, 0x0000, 0x0000, 0x0000};  // All SPI delays disabled, no CS toggle
+    setup(CP2130::CFRQ750K, delays, errcnt, errstr);
+}
+
+// Sets up and prepares the device, using the given SPI clock frequency and delays (added in version 1.1.0)
+// Any clock frequency supported by the CP2130 is valid, since the LTC2640 accepts clock frequencies up to 50MHz
+// However, the CS toggle must be disabled, because the LTC2640 only accepts a command if its chip select is held low for all 24 bits
+void FAU201Device::setup(uint8_t cfrq, const CP2130::SPIDelays &delays, int &errcnt, std::string &errstr)
+{
+    if (cfrq > CFRQ_LAST) {
+        ++errcnt;
+        errstr += "In setup(): SPI clock frequency value must be between 0 and 7.\n";  // Program logic error
+    } else if (delays.cstglen) {
+        ++errcnt;
+        errstr += "In setup(): CS toggle must be disabled.\n";  // Program logic error
+    } else {
+        int preverrcnt = errcnt;
+        CP2130::SPIMode mode;
+        mode.csmode = CP2130::CSMODEPP;  // Chip select pin mode regarding channel 0 is push-pull
+        mode.cfrq = cfrq;  // SPI clock frequency set to the given value (750KHz up to version 1.0.1)
+        mode.cpol = CP2130::CPOL0;  // SPI clock polarity is active high (CPOL = 0)
+        mode.cpha = CP2130::CPHA0;  // SPI data is valid on each rising edge (CPHA = 0)
+        cp2130_.configureSPIMode(0, mode, errcnt, errstr);  // Configure SPI mode for channel 0, using the above settings
+        cp2130_.configureSPIDelays(0, delays, errcnt, errstr);  // Configure SPI delays for channel 0 (all of them were disabled up to version 1.0.1)
+        cfrq_ = cfrq;
+        delays_ = delays;
+        codeKnown_ = false;  // The DAC may have been power cycled since the last update
+        cp2130_.selectCS(0, errcnt, errstr);  // Enable the chip select corresponding to channel 0, and disable any others
+        settle();  // Wait for the chip select to settle, in order to prevent possible errors after enabling it (workaround implemented in version 1.0.1)
+        uint8_t config[3] = {0x70, 0x00, 0x00};  // Use external voltage reference
+        cp2130_.spiWrite(config, sizeof(config), cp2130_.getEndpointOutAddr(errcnt, errstr), errcnt, errstr);  // Send the configuration above to the LTC2640 DAC (since version 1.1.0, the endpoint address is no longer hard-coded, and is cached by the CP2130 class instead)
+        if (!streaming_) {  // In streaming mode, the chip select is left enabled (implemented in version 1.1.0)
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors while disabling it (workaround)
+            cp2130_.disableCS(0, errcnt, errstr);  // Disable the previously enabled chip select
+        }
+        setUp_ = errcnt == preverrcnt;
+    }
+}
+
+// Sets the output voltage to a given value, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.1.0)
+// No strings are touched by this function, so it is suitable for long running loops (see CP2130::Status::message() for getting the corresponding error message)
+// Unlike the next function, the update is skipped if the chip select cannot be enabled, and only the first failure is returned
+// As in the next function, no transactions take place if the DAC is known to hold the code corresponding to the given voltage already, unless "force" is true
+// This function is implemented on top of setVoltageCode(uint16_t, bool)
+CP2130::Status FAU201Device::setVoltage(float voltage, bool force)
+{
+    CP2130::Status status = {CP2130::STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (voltage < VOLTAGE_MIN || voltage > VOLTAGE_MAX) {
+        status.code = CP2130::STATUS_INVALID_ARGUMENT;  // Program logic error
+        status.function = "setVoltage";
+        status.detail = "Voltage must be between 0 and 4.095.";
+    } else {
+        status = setVoltageCode(voltageCode(voltage), force);
+    }
+    return status;
 }
 
 // Sets the output voltage to a given value
+// Since version 1.1.0, this is equivalent to calling the next function with "force" set to false
 void FAU201Device::setVoltage(float voltage, int &errcnt, std::string &errstr)
+{
+    setVoltage(voltage, false, errcnt, errstr);
+}
+
+// Sets the output voltage to a given value, skipping all transactions if the DAC is known to hold the corresponding code already, unless "force" is true (added in version 1.1.0)
+// The DAC code is known once it is successfully written, and becomes unknown whenever the device is closed, reset or set up, or a batch is executed
+// Setting "force" to true also causes the chip select to be set again, which is useful if the device may have been changed by other means
+// This function is implemented on top of setVoltageCode(uint16_t, bool, int &, std::string &)
+void FAU201Device::setVoltage(float voltage, bool force, int &errcnt, std::string &errstr)
 {
     if (voltage < VOLTAGE_MIN || voltage > VOLTAGE_MAX) {
         ++errcnt;
         errstr += "In setVoltage(): Voltage must be between 0 and 4.095.\n";  // Program logic error
     } else {
-        cp2130_.selectCS(0, errcnt, errstr);  // Enable the chip select corresponding to channel 0, and disable any others
-        usleep(100);  // Wait 100us, in order to prevent possible errors after enabling the chip select (workaround implemented in version 1.0.1)
-        uint16_t voltageCode = static_cast<uint16_t>(voltage * 1000 + 0.5);
-        std::vector<uint8_t> set = {
-            0x30,                                    // Input and DAC registers updated to the given value
-            static_cast<uint8_t>(voltageCode >> 4),  // Upper 8 bits of the 12-bit value
-            static_cast<uint8_t>(voltageCode << 4)   // Lower 4 bits of the value, followed by four zero bits
-        };
-        cp2130_.spiWrite(set, EPOUT, errcnt, errstr);  // Set the output voltage by updating the above registers
-        usleep(100);  // Wait 100us, in order to prevent possible errors while disabling the chip select (workaround)
-        cp2130_.disableCS(0, errcnt, errstr);  // Disable the previously enabled chip select
+        setVoltageCode(voltageCode(voltage), force, errcnt, errstr);
+    }
+}
+
+// Sets the output voltage to a given value, asynchronously, and invokes the given callback on completion (added in version 1.1.0)
+// This function requires streaming mode to be enabled, so that the update consists of a single bulk OUT transfer
+void FAU201Device::setVoltageAsync(float voltage, const CP2130::TransferCallback &callback, int &errcnt, std::string &errstr)
+{
+    if (voltage < VOLTAGE_MIN || voltage > VOLTAGE_MAX) {
+        ++errcnt;
+        errstr += "In setVoltageAsync(): Voltage must be between 0 and 4.095.\n";  // Program logic error
+    } else if (!streaming_) {
+        ++errcnt;
+        errstr += "In setVoltageAsync(): Streaming mode must be enabled.\n";  // Program logic error
+    } else {
+        uint8_t endpointOutAddr;
+        CP2130::Status status = cp2130_.getEndpointOutAddr(endpointOutAddr);  // Resolved beforehand, since the update must not be submitted to a fallback endpoint
+        if (status.code != CP2130::STATUS_OK) {
+            ++errcnt;
+            errstr += status.message();
+        } else {
+            Frame frame = codeFrame(voltageCode(voltage));
+            int preverrcnt = errcnt;
+            codeKnown_ = false;  // The outcome is only known once the callback is invoked
+            cp2130_.spiWriteAsync(frame.bytes, sizeof(frame.bytes), endpointOutAddr, callback, errcnt, errstr);
+            if (errcnt == preverrcnt) {  // The voltage is considered set as soon as the update is submitted (see restore())
+                voltageKnown_ = true;
+                voltage_ = voltage;
+            }
+        }
+    }
+}
+
+#ifdef CP2130_COROUTINES
+// Sets the output voltage to a given value, asynchronously, returning an awaitable that yields the result of the update (see CP2130::TransferAwaitable - added in version 1.1.0)
+// As in the previous function, streaming mode must be enabled, and the awaiting coroutine must not access the device in any other way until resumed
+CP2130::TransferAwaitable FAU201Device::setVoltageAsync(float voltage, int &errcnt, std::string &errstr)
+{
+    CP2130::TransferAwaitable awaitable;
+    int preverrcnt = errcnt;
+    setVoltageAsync(voltage, awaitable.callback(), errcnt, errstr);
+    if (errcnt != preverrcnt) {  // If the update could not be submitted, the awaitable is completed right away
+        awaitable.callback()(LIBUSB_TRANSFER_ERROR, 0);
+    }
+    return awaitable;
+}
+#endif
+
+// Sets the output voltage by writing the given 12-bit code to the DAC, returning a status instead of reporting errors via "errcnt" and "errstr" (added in version 1.1.0)
+// Since each code step corresponds to 1mV, no conversions are involved, and precomputed codes can be written with no per-update arithmetic
+// See setVoltage(float, bool) for details
+CP2130::Status FAU201Device::setVoltageCode(uint16_t code, bool force)
+{
+    CP2130::Status status = {CP2130::STATUS_OK, 0, nullptr, nullptr, 0x00, 0x00, 0x00};
+    if (code > CODE_MAX) {
+        status.code = CP2130::STATUS_INVALID_ARGUMENT;  // Program logic error
+        status.function = "setVoltageCode";
+        status.detail = "Code must be between 0 and 4095.";
+    } else if (!force && codeKnown_ && code_ == code) {  // Redundant update
+        voltageKnown_ = true;
+        voltage_ = static_cast<float>(code) / 1000;
+    } else {
+        if (force) {
+            cp2130_.invalidateCS();  // The chip select is set again as well
+        }
+        if (!streaming_) {  // Otherwise, the chip select is already enabled (see setStreamingMode())
+            status = cp2130_.selectCS(0);  // Enable the chip select corresponding to channel 0, and disable any others
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors after enabling it (see setVoltageCode(uint16_t, bool, int &, std::string &))
+        }
+        uint8_t endpointOutAddr;
+        if (status.code == CP2130::STATUS_OK) {
+            status = cp2130_.getEndpointOutAddr(endpointOutAddr);
+        }
+        if (status.code == CP2130::STATUS_OK) {
+            Frame set = codeFrame(code);  // Input and DAC registers updated to the given value
+            status = cp2130_.spiWrite(set.bytes, sizeof(set.bytes), endpointOutAddr);  // Set the output voltage by updating the above registers
+            codeKnown_ = status.code == CP2130::STATUS_OK;  // A failed write may or may not have reached the DAC
+            code_ = code;
+            if (status.code == CP2130::STATUS_OK) {  // Keep track of the last voltage that was set (see restore())
+                voltageKnown_ = true;
+                voltage_ = static_cast<float>(code) / 1000;
+            }
+        }
+        if (!streaming_) {
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors while disabling it (see setVoltageCode(uint16_t, bool, int &, std::string &))
+            CP2130::Status disableStatus = cp2130_.disableCS(0);  // Disable the previously enabled chip select, even if a previous step failed
+            if (status.code == CP2130::STATUS_OK) {
+                status = disableStatus;
+            }
+        }
+    }
+    return status;
+}
+
+// Sets the output voltage by writing the given 12-bit code to the DAC (added in version 1.1.0)
+// This is equivalent to calling the next function with "force" set to false
+void FAU201Device::setVoltageCode(uint16_t code, int &errcnt, std::string &errstr)
+{
+    setVoltageCode(code, false, errcnt, errstr);
+}
+
+// Sets the output voltage by writing the given 12-bit code to the DAC, unless the DAC is known to hold that code already and "force" is false (added in version 1.1.0)
+// See setVoltage(float, bool, int &, std::string &) for details
+void FAU201Device::setVoltageCode(uint16_t code, bool force, int &errcnt, std::string &errstr)
+{
+    if (code > CODE_MAX) {
+        ++errcnt;
+        errstr += "In setVoltageCode(): Code must be between 0 and 4095.\n";  // Program logic error
+    } else if (!force && codeKnown_ && code_ == code) {  // Redundant update
+        voltageKnown_ = true;
+        voltage_ = static_cast<float>(code) / 1000;
+    } else {
+        if (force) {
+            cp2130_.invalidateCS();  // The chip select is set again as well
+        }
+        int initerrcnt = errcnt;
+        if (!streaming_) {  // Otherwise, the chip select is already enabled (see setStreamingMode())
+            cp2130_.selectCS(0, errcnt, errstr);  // Enable the chip select corresponding to channel 0, and disable any others
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors after enabling it (workaround implemented in version 1.0.1)
+        }
+        Frame set = codeFrame(code);  // Input and DAC registers updated to the given value (a plain structure is used, in order to avoid allocations)
+        int preverrcnt = errcnt;
+        cp2130_.spiWrite(set.bytes, sizeof(set.bytes), cp2130_.getEndpointOutAddr(errcnt, errstr), errcnt, errstr);  // Set the output voltage by updating the above registers
+        if (errcnt == preverrcnt) {  // Keep track of the last voltage that was set, so it can be restored later
+            voltageKnown_ = true;
+            voltage_ = static_cast<float>(code) / 1000;
+        }
+        codeKnown_ = errcnt == initerrcnt;  // The DAC code is only known if the chip select was enabled as well
+        code_ = code;
+        if (!streaming_) {
+            settle();  // Wait for the chip select to settle, in order to prevent possible errors while disabling it (workaround)
+            cp2130_.disableCS(0, errcnt, errstr);  // Disable the previously enabled chip select
+        }
     }
 }
 
+// Helper function to enumerate devices, returning one record per device found (added in version 1.1.0)
+std::vector<CP2130::DeviceRecord> FAU201Device::enumerateDevices(int &errcnt, std::string &errstr)
+{
+    return CP2130::enumerateDevices(VID, PID, errcnt, errstr);
+}
+
+// Same as the previous function, but using the given libusb context (added in version 1.1.0)
+std::vector<CP2130::DeviceRecord> FAU201Device::enumerateDevices(libusb_context *context, int &errcnt, std::string &errstr)
+{
+    return CP2130::enumerateDevices(context, VID, PID, errcnt, errstr);
+}
+
+// Same as the previous function, but writing the records to the given vector, whose existing records are reused (see CP2130::enumerateDevices() - added in version 1.1.0)
+void FAU201Device::enumerateDevices(libusb_context *context, std::vector<CP2130::DeviceRecord> &devices, int &errcnt, std::string &errstr)
+{
+    CP2130::enumerateDevices(context, VID, PID, devices, errcnt, errstr);
+}
+
 // Helper function that returns the hardware revision from a given USB configuration
 std::string FAU201Device::hardwareRevision(const CP2130::USBConfig &config)
 {
@@ -158,3 +1145,55 @@ std::list<std::string> FAU201Device::listDevices(int &errcnt, std::string &errst
 {
     return CP2130::listDevices(VID, PID, errcnt, errstr);
 }
+
+// Helper function to list devices into the given vector, replacing its contents (see CP2130::listDevices() - added in version 1.1.0)
+void FAU201Device::listDevices(std::vector<std::string> &devices, int &errcnt, std::string &errstr)
+{
+    CP2130::listDevices(VID, PID, devices, errcnt, errstr);
+}
+
+// Helper function that returns the maximum sample rate, in hertz, that can be achieved by playSequence() given a clock frequency and SPI delays (added in version 1.1.0)
+// This is determined by the duration of each frame, which is the time taken to clock the 24 bits, plus the enabled delays and the nominal overhead of each write command
+float FAU201Device::maxSampleRate(uint8_t cfrq, const CP2130::SPIDelays &delays)
+{
+    float frameTime = static_cast<float>(FRAME_BITS * (1 << (0x07 & cfrq))) / 12 + SEQ_FRAMEOVERHEAD;  // The CP2130 clock frequency is 12MHz divided by 2 to the power of "cfrq"
+    if (delays.itbyten) {
+        frameTime += 2 * 10 * delays.itbytdly;  // Each frame has two inter-byte gaps
+    }
+    if (delays.pstasten) {
+        frameTime += 10 * delays.pstastdly;
+    }
+    if (delays.prdasten) {
+        frameTime += 10 * delays.prdastdly;
+    }
+    return 1000000 / frameTime;
+}
+
+// Helper function that returns the DAC codes of the given ramp, sampled at the given number of evenly spaced points in time, including the start and end voltages (added in version 1.1.0)
+// The duration of the ramp is not taken into account, since the codes only depend on the shape, so these can be played at any rate by playSequence() or by FAU201Scheduler
+std::vector<uint16_t> FAU201Device::rampCodes(const Ramp &ramp, size_t steps, int &errcnt, std::string &errstr)
+{
+    std::vector<uint16_t> codes;
+    if (ramp.start < VOLTAGE_MIN || ramp.start > VOLTAGE_MAX || ramp.end < VOLTAGE_MIN || ramp.end > VOLTAGE_MAX) {
+        ++errcnt;
+        errstr += "In rampCodes(): Voltages must be between 0 and 4.095.\n";  // Program logic error
+    } else if (ramp.shape != RAMP_LINEAR && ramp.shape != RAMP_EXPONENTIAL) {
+        ++errcnt;
+        errstr += "In rampCodes(): Shape must be RAMP_LINEAR or RAMP_EXPONENTIAL.\n";  // Program logic error
+    } else if (steps < 2) {
+        ++errcnt;
+        errstr += "In rampCodes(): Number of steps must be at least 2.\n";  // Program logic error
+    } else {
+        codes.resize(steps);
+        double scale = 1 - std::exp(-RAMP_EXPRATE);  // Applicable to exponential ramps
+        for (size_t i = 0; i < steps; ++i) {
+            double progress = static_cast<double>(i) / static_cast<double>(steps - 1);
+            if (ramp.shape == RAMP_EXPONENTIAL) {
+                progress = (1 - std::exp(-RAMP_EXPRATE * progress)) / scale;
+            }
+            codes[i] = voltageCode(static_cast<float>(ramp.start + (ramp.end - ramp.start) * progress));
+        }
+        codes.back() = voltageCode(ramp.end);  // Rounding errors aside, the end voltage is always reached
+    }
+    return codes;
+}
@@ -1,6 +1,6 @@
-/* FAU201 device class - Version 1.0.1
-   Requires CP2130 class version 1.1.0 or later
-   Copyright (c) 2022 Samuel Lourenço
+/* FAU201 device class - Version 1.1.0
+   Requires CP2130 class version 1.3.0 or later
+   Copyright (c) 2022-2026 Samuel Lourenço
 
    This library is free software: you can redistribute it and/or modify it
    under the terms of the GNU Lesser General Public License as published by
@@ -23,15 +23,40 @@
 #define FAU201DEVICE_H
 
 // Includes
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <list>
 #include <string>
+#include <vector>
 #include "cp2130.h"
 
 class FAU201Device
 {
 private:
     CP2130 cp2130_;
+    bool streaming_;
+    bool setUp_;  // True once setup() succeeds, or once a snapshot is restored (see saveSnapshot())
+    bool voltageKnown_;
+    float voltage_;
+    bool codeKnown_;
+    uint16_t code_;
+    uint8_t cfrq_;
+    CP2130::SPIDelays delays_;
+    bool manufacturerCached_, productCached_, serialCached_, siliconVersionCached_, usbConfigCached_, pinConfigCached_;
+    std::u16string manufacturer_, product_, serial_;
+    CP2130::SiliconVersion siliconVersion_;
+    CP2130::USBConfig usbConfig_;
+    CP2130::PinConfig pinConfig_;
+    std::atomic<uint64_t> settles_, settleTime_;
+    uint8_t settleMode_;
+    uint16_t settleDelay_;
+
+    void invalidateIdentity();
+    void settle();
+
+    static bool readSnapshotString(const std::vector<uint8_t> &buffer, size_t &index, std::u16string &string);
+    static void writeSnapshotString(std::vector<uint8_t> &buffer, const std::u16string &string);
 
 public:
     // Class definitions
@@ -46,25 +71,164 @@ public:
     static constexpr float VOLTAGE_MIN = 0;       // Minimum voltage
     static constexpr float VOLTAGE_MAX = 4.095;   // Maximum voltage
 
+    // Limits applicable to setMillivolts() and setVoltageCode() (added in version 1.1.0)
+    static const uint16_t MILLIVOLTS_MAX = 4095;  // Maximum voltage, in millivolts
+    static const uint16_t CODE_MAX = 4095;        // Maximum DAC code (each code step corresponds to 1mV, given the 4.096V reference)
+
+    // Limit applicable to setup() (added in version 1.1.0)
+    static const uint8_t CFRQ_LAST = CP2130::CFRQ938;  // Last valid clock frequency value, which is the slowest clock (93.8KHz)
+
+    // Limit applicable to playSequence()
+    static const uint16_t INTERVAL_MAX = 25000;  // Maximum sample interval, in 10us units (this keeps each transfer well within the transfer timeout)
+
+    // Ramp shapes applicable to Ramp (added in version 1.1.0)
+    static const uint8_t RAMP_LINEAR = 0x00;       // Linear ramp
+    static const uint8_t RAMP_EXPONENTIAL = 0x01;  // Exponential approach, as in the step response of a first order system, but reaching the end voltage exactly
+
+    // Settling modes applicable to SettlePolicy (added in version 1.1.0)
+    static const uint8_t SETTLE_NONE = 0x00;      // No settling delay, which is only advisable if the post-assert and pre-deassert delays are enabled (see setup())
+    static const uint8_t SETTLE_BUSYWAIT = 0x01;  // Busy-wait on a steady clock, which is precise but keeps the calling thread busy
+    static const uint8_t SETTLE_SLEEP = 0x02;     // Sleep, which is subject to the scheduler and may take considerably longer than intended (default)
+
+    // Limits applicable to setSettlePolicy() (added in version 1.1.0)
+    static const uint16_t SETTLE_DELAY_DEFAULT = 100;  // Default settling delay, in microseconds, as used up to version 1.0.1
+    static const uint16_t SETTLE_BUSYWAIT_MAX = 1000;  // Maximum settling delay when busy-waiting, in microseconds
+
+    // LTC2640 command, as returned by codeFrame() and voltageFrame() (added in version 1.1.0)
+    struct Frame {
+        uint8_t bytes[3];  // Command byte, followed by the 12-bit code and four zero bits
+
+        bool operator ==(const Frame &other) const;
+        bool operator !=(const Frame &other) const;
+    };
+
+    // Voltage ramp, as accepted by playRamp() and rampCodes() (added in version 1.1.0)
+    struct Ramp {
+        float start;                         // Start voltage
+        float end;                           // End voltage
+        std::chrono::microseconds duration;  // Duration of the ramp (not applicable to rampCodes())
+        uint8_t shape;                       // Shape of the ramp (RAMP_LINEAR or RAMP_EXPONENTIAL)
+
+        bool operator ==(const Ramp &other) const;
+        bool operator !=(const Ramp &other) const;
+    };
+
+    // Settling diagnostic, as returned by diagnoseSettleDelay() (added in version 1.1.0)
+    struct SettleDiagnostic {
+        std::string revision;  // Hardware revision of the device (see getHardwareRevision())
+        uint16_t delay;        // Minimum settling delay, in microseconds, for which no failures were observed
+        bool safe;             // False if failures were observed even with the default settling delay, in which case "delay" is meaningless
+
+        bool operator ==(const SettleDiagnostic &other) const;
+        bool operator !=(const SettleDiagnostic &other) const;
+    };
+
+    // Settling policy, as returned by getSettlePolicy() (added in version 1.1.0)
+    struct SettlePolicy {
+        uint8_t mode;    // Settling mode (SETTLE_NONE, SETTLE_BUSYWAIT or SETTLE_SLEEP)
+        uint16_t delay;  // Settling delay, in microseconds (not applicable to SETTLE_NONE)
+
+        bool operator ==(const SettlePolicy &other) const;
+        bool operator !=(const SettlePolicy &other) const;
+    };
+
+    // Statistics, as returned by getStats() (added in version 1.1.0)
+    struct Stats {
+        CP2130::Stats transfers;  // Transfer statistics of the underlying CP2130 (see CP2130::getStats())
+        uint64_t settles;         // Number of settling delays, taken around each change of the chip select (see setVoltage())
+        uint64_t settleTime;      // Total time spent in settling delays, in microseconds, as measured
+
+        bool operator ==(const Stats &other) const;
+        bool operator !=(const Stats &other) const;
+    };
+
     FAU201Device();
 
     bool disconnected() const;
     bool isOpen() const;
+    bool isStatsEnabled() const;
+    bool isStreaming() const;
+    float maxSampleRate() const;
 
+    void appendVoltage(CP2130::Batch &batch, float voltage, int &errcnt, std::string &errstr);
     void close();
+    SettleDiagnostic diagnoseSettleDelay(uint16_t iterations, int &errcnt, std::string &errstr);
+    void disableStats();
+    void enableStats();
+    void executeBatch(const CP2130::Batch &batch, int &errcnt, std::string &errstr);
+    CP2130::PinConfig getCP2130PinConfig(int &errcnt, std::string &errstr);
     CP2130::SiliconVersion getCP2130SiliconVersion(int &errcnt, std::string &errstr);
     std::string getHardwareRevision(int &errcnt, std::string &errstr);
     std::u16string getManufacturerDesc(int &errcnt, std::string &errstr);
     std::u16string getProductDesc(int &errcnt, std::string &errstr);
     std::u16string getSerialDesc(int &errcnt, std::string &errstr);
+    SettlePolicy getSettlePolicy() const;
+    Stats getStats() const;
+    CP2130::TransferPolicy getTransferPolicy(uint8_t transferClass, int &errcnt, std::string &errstr) const;
     CP2130::USBConfig getUSBConfig(int &errcnt, std::string &errstr);
     int open(const std::string &serial = std::string());
+    int open(libusb_context *context, const std::string &serial = std::string());
+    int open(const CP2130::DeviceRecord &record);
+    int open(libusb_context *context, const CP2130::DeviceRecord &record);
+    int open(USBTransport *transport);
+    void playRamp(const Ramp &ramp, int &errcnt, std::string &errstr);
+    void playSequence(const std::vector<float> &voltages, uint16_t interval, int &errcnt, std::string &errstr);
+    void playSequence(const std::vector<Frame> &frames, uint16_t interval, int &errcnt, std::string &errstr);
+    void refresh(int &errcnt, std::string &errstr);
     void reset(int &errcnt, std::string &errstr);
+    void resetStats();
+    void restore(int &errcnt, std::string &errstr);
+    bool restoreSnapshot(const std::string &path, int &errcnt, std::string &errstr);
+    void saveSnapshot(const std::string &path, int &errcnt, std::string &errstr);
+    CP2130::Status setMillivolts(uint16_t millivolts, bool force = false);
+    void setMillivolts(uint16_t millivolts, int &errcnt, std::string &errstr);
+    void setSettlePolicy(const SettlePolicy &policy, int &errcnt, std::string &errstr);
+    void setStreamingMode(bool enable, int &errcnt, std::string &errstr);
+    void setTransferPolicy(uint8_t transferClass, const CP2130::TransferPolicy &policy, int &errcnt, std::string &errstr);
     void setup(int &errcnt, std::string &errstr);
+    void setup(uint8_t cfrq, const CP2130::SPIDelays &delays, int &errcnt, std::string &errstr);
+    CP2130::Status setVoltage(float voltage, bool force = false);
     void setVoltage(float voltage, int &errcnt, std::string &errstr);
-
+    void setVoltage(float voltage, bool force, int &errcnt, std::string &errstr);
+    void setVoltageAsync(float voltage, const CP2130::TransferCallback &callback, int &errcnt, std::string &errstr);
+#ifdef CP2130_COROUTINES
+    CP2130::TransferAwaitable setVoltageAsync(float voltage, int &errcnt, std::string &errstr);
+#endif
+    CP2130::Status setVoltageCode(uint16_t code, bool force = false);
+    void setVoltageCode(uint16_t code, int &errcnt, std::string &errstr);
+    void setVoltageCode(uint16_t code, bool force, int &errcnt, std::string &errstr);
+
+    // Helper function that returns the LTC2640 command that updates the DAC to the given code, which must not be greater than CODE_MAX (added in version 1.1.0)
+    // Being "constexpr", this function can be used to build waveform tables at compile time (see playSequence())
+    static constexpr Frame codeFrame(uint16_t code)
+    {
+        return Frame{{
+            0x30,                             // Input and DAC registers updated to the given value
+            static_cast<uint8_t>(code >> 4),  // Upper 8 bits of the 12-bit value
+            static_cast<uint8_t>(code << 4)   // Lower 4 bits of the value, followed by four zero bits
+        }};
+    }
+
+    static std::vector<CP2130::DeviceRecord> enumerateDevices(int &errcnt, std::string &errstr);
+    static std::vector<CP2130::DeviceRecord> enumerateDevices(libusb_context *context, int &errcnt, std::string &errstr);
+    static void enumerateDevices(libusb_context *context, std::vector<CP2130::DeviceRecord> &devices, int &errcnt, std::string &errstr);
     static std::string hardwareRevision(const CP2130::USBConfig &config);
     static std::list<std::string> listDevices(int &errcnt, std::string &errstr);
+    static void listDevices(std::vector<std::string> &devices, int &errcnt, std::string &errstr);
+    static float maxSampleRate(uint8_t cfrq, const CP2130::SPIDelays &delays);
+    static std::vector<uint16_t> rampCodes(const Ramp &ramp, size_t steps, int &errcnt, std::string &errstr);
+
+    // Helper function that returns the DAC code corresponding to the given voltage, which must be between VOLTAGE_MIN and VOLTAGE_MAX (added in version 1.1.0)
+    static constexpr uint16_t voltageCode(float voltage)
+    {
+        return static_cast<uint16_t>(voltage * 1000 + 0.5);
+    }
+
+    // Helper function that returns the LTC2640 command that sets the output to the given voltage, which must be between VOLTAGE_MIN and VOLTAGE_MAX (added in version 1.1.0)
+    static constexpr Frame voltageFrame(float voltage)
+    {
+        return codeFrame(voltageCode(voltage));
+    }
 };
 
 #endif  // FAU201DEVICE_H
@@ -0,0 +1,236 @@
+/* FAU201 multi-channel device class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "fau201multidevice.h"
+
+FAU201MultiDevice::FAU201MultiDevice() :
+    cp2130_(),
+    channels_(0x0000),
+    codesKnown_(0x0000),
+    codes_(),
+    settleDelay_(FAU201Device::SETTLE_DELAY_DEFAULT)
+{
+}
+
+// Returns the channels that were set up, in ascending order
+std::vector<uint8_t> FAU201MultiDevice::channels() const
+{
+    std::vector<uint8_t> list;
+    for (uint8_t channel = 0; channel <= CHANNEL_MAX; ++channel) {
+        if ((0x0001 << channel & channels_) != 0) {
+            list.push_back(channel);
+        }
+    }
+    return list;
+}
+
+// Diagnostic function used to verify if the device has been disconnected
+bool FAU201MultiDevice::disconnected() const
+{
+    return cp2130_.disconnected();
+}
+
+// Returns the settling delay, in microseconds, taken after each change of the chip select
+uint16_t FAU201MultiDevice::getSettleDelay() const
+{
+    return settleDelay_;
+}
+
+// Checks if the given channel was set up
+bool FAU201MultiDevice::isChannelSetUp(uint8_t channel) const
+{
+    return channel <= CHANNEL_MAX && (0x0001 << channel & channels_) != 0;
+}
+
+// Checks if the device is open
+bool FAU201MultiDevice::isOpen() const
+{
+    return cp2130_.isOpen();
+}
+
+// Closes the device safely, if open
+void FAU201MultiDevice::close()
+{
+    cp2130_.close();
+    channels_ = 0x0000;  // Every channel has to be set up again once the device is reopened
+    codesKnown_ = 0x0000;
+}
+
+// Opens the device having the given VID, PID and, optionally, the given serial number, and assigns its handle
+// Since variants usually have their own IDs, these must be given explicitly
+int FAU201MultiDevice::open(uint16_t vid, uint16_t pid, const std::string &serial)
+{
+    return cp2130_.open(vid, pid, serial);
+}
+
+// Opens the device having the given VID, PID and, optionally, the given serial number, using the given libusb context that is owned by the caller
+int FAU201MultiDevice::open(libusb_context *context, uint16_t vid, uint16_t pid, const std::string &serial)
+{
+    return cp2130_.open(context, vid, pid, serial);
+}
+
+// Opens the device through the given transport, which is not owned by the device (see CP2130::open(USBTransport *))
+int FAU201MultiDevice::open(USBTransport *transport)
+{
+    return cp2130_.open(transport);
+}
+
+// Sets the settling delay, in microseconds, taken after each change of the chip select, or disables it if zero
+// Unlike FAU201Device, which can busy-wait, these delays are always slept, since they are part of a command batch
+void FAU201MultiDevice::setSettleDelay(uint16_t delay)
+{
+    settleDelay_ = delay;
+}
+
+// Sets up the DAC connected to the given channel, by configuring the SPI mode and delays of that channel, and then selecting the external voltage reference
+// This only needs to be done once per channel, since the CP2130 keeps the configuration of each channel, and the configuration is not repeated for every update
+void FAU201MultiDevice::setupChannel(uint8_t channel, uint8_t cfrq, const CP2130::SPIDelays &delays, int &errcnt, std::string &errstr)
+{
+    if (channel > CHANNEL_MAX) {
+        ++errcnt;
+        errstr += "In setupChannel(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+    } else if (cfrq > FAU201Device::CFRQ_LAST) {
+        ++errcnt;
+        errstr += "In setupChannel(): SPI clock frequency value must be between 0 and 7.\n";  // Program logic error
+    } else if (delays.cstglen) {
+        ++errcnt;
+        errstr += "In setupChannel(): CS toggle must be disabled.\n";  // Program logic error
+    } else {
+        int preverrcnt = errcnt;
+        uint16_t bitmap = static_cast<uint16_t>(0x0001 << channel);
+        channels_ = static_cast<uint16_t>(channels_ & ~bitmap);
+        codesKnown_ = static_cast<uint16_t>(codesKnown_ & ~bitmap);  // The DAC may have been power cycled since the last update
+        CP2130::SPIMode mode;
+        mode.csmode = CP2130::CSMODEPP;  // Chip select pin mode regarding the given channel is push-pull
+        mode.cfrq = cfrq;  // SPI clock frequency set to the given value
+        mode.cpol = CP2130::CPOL0;  // SPI clock polarity is active high (CPOL = 0)
+        mode.cpha = CP2130::CPHA0;  // SPI data is valid on each rising edge (CPHA = 0)
+        cp2130_.configureSPIMode(channel, mode, errcnt, errstr);
+        cp2130_.configureSPIDelays(channel, delays, errcnt, errstr);
+        uint8_t endpointOutAddr = cp2130_.getEndpointOutAddr(errcnt, errstr);
+        if (errcnt == preverrcnt) {
+            CP2130::Batch batch;
+            batch.selectCS(channel, errcnt, errstr);  // Enable the chip select corresponding to the given channel, and disable any others
+            if (settleDelay_ != 0) {
+                batch.delay(settleDelay_);  // Wait for the chip select to settle, in order to prevent possible errors after enabling it
+            }
+            uint8_t config[3] = {0x70, 0x00, 0x00};  // Use external voltage reference
+            batch.spiWrite(config, sizeof(config), endpointOutAddr);
+            if (settleDelay_ != 0) {
+                batch.delay(settleDelay_);  // Wait for the chip select to settle, in order to prevent possible errors while disabling it
+            }
+            batch.disableCS(channel, errcnt, errstr);  // Disable the previously enabled chip select
+            cp2130_.executeBatch(batch, errcnt, errstr);
+        }
+        if (errcnt == preverrcnt) {
+            channels_ = static_cast<uint16_t>(channels_ | bitmap);
+        }
+    }
+}
+
+// Sets the output voltage of the given channel (see setVoltages())
+void FAU201MultiDevice::setVoltage(uint8_t channel, float voltage, int &errcnt, std::string &errstr)
+{
+    std::map<uint8_t, float> voltages;
+    voltages[channel] = voltage;
+    setVoltages(voltages, errcnt, errstr);
+}
+
+// Updates the DACs of the given channels to the given codes, in ascending order of channel, via a single command batch
+// Each update selects the chip select of its channel, which also disables the chip select of the previous one, so that updating N channels takes 2N + 1 transfers, instead of 3N
+// These are not issued back to back, since CP2130::executeBatch() waits for every control transfer to complete before a bulk transfer, and vice versa, and sleeps through any settling delays, so each transfer costs a round trip
+// Redundant updates are skipped, unless "force" is true, and no transfers take place if every update is redundant
+void FAU201MultiDevice::setVoltageCodes(const std::map<uint8_t, uint16_t> &codes, bool force, int &errcnt, std::string &errstr)
+{
+    bool valid = true;
+    for (std::map<uint8_t, uint16_t>::const_iterator it = codes.begin(); it != codes.end(); ++it) {
+        if (it->first > CHANNEL_MAX) {
+            ++errcnt;
+            errstr += "In setVoltageCodes(): SPI channel value must be between 0 and 10.\n";  // Program logic error
+            valid = false;
+        } else if ((0x0001 << it->first & channels_) == 0) {
+            ++errcnt;
+            errstr += "In setVoltageCodes(): Channel is not set up.\n";  // Program logic error
+            valid = false;
+        } else if (it->second > FAU201Device::CODE_MAX) {
+            ++errcnt;
+            errstr += "In setVoltageCodes(): Code must be between 0 and 4095.\n";  // Program logic error
+            valid = false;
+        }
+    }
+    if (valid) {
+        int preverrcnt = errcnt;
+        uint8_t endpointOutAddr = cp2130_.getEndpointOutAddr(errcnt, errstr);
+        CP2130::Batch batch;
+        uint16_t updated = 0x0000;
+        uint8_t last = 0;
+        for (std::map<uint8_t, uint16_t>::const_iterator it = codes.begin(); it != codes.end(); ++it) {
+            uint16_t bitmap = static_cast<uint16_t>(0x0001 << it->first);
+            if (force || (bitmap & codesKnown_) == 0 || codes_[it->first] != it->second) {
+                if (updated != 0x0000 && settleDelay_ != 0) {
+                    batch.delay(settleDelay_);  // Wait for the chip select of the previous channel to settle, in order to prevent possible errors while disabling it
+                }
+                batch.selectCS(it->first, errcnt, errstr);  // Enable the chip select corresponding to the channel, and disable any others
+                if (settleDelay_ != 0) {
+                    batch.delay(settleDelay_);  // Wait for the chip select to settle, in order to prevent possible errors after enabling it
+                }
+                FAU201Device::Frame set = FAU201Device::codeFrame(it->second);  // Input and DAC registers updated to the given value
+                batch.spiWrite(set.bytes, sizeof(set.bytes), endpointOutAddr);
+                updated = static_cast<uint16_t>(updated | bitmap);
+                last = it->first;
+            }
+        }
+        if (updated != 0x0000 && errcnt == preverrcnt) {
+            if (settleDelay_ != 0) {
+                batch.delay(settleDelay_);  // Wait for the chip select to settle, in order to prevent possible errors while disabling it
+            }
+            batch.disableCS(last, errcnt, errstr);  // Disable the chip select of the last channel
+            codesKnown_ = static_cast<uint16_t>(codesKnown_ & ~updated);  // A failed batch may or may not have reached each DAC
+            cp2130_.executeBatch(batch, errcnt, errstr);
+            if (errcnt == preverrcnt) {
+                for (std::map<uint8_t, uint16_t>::const_iterator it = codes.begin(); it != codes.end(); ++it) {
+                    codes_[it->first] = it->second;
+                }
+                codesKnown_ = static_cast<uint16_t>(codesKnown_ | updated);
+            }
+        }
+    }
+}
+
+// Sets the output voltages of the given channels, which must be between 0 and 4.095V, via a single command batch (see setVoltageCodes())
+void FAU201MultiDevice::setVoltages(const std::map<uint8_t, float> &voltages, int &errcnt, std::string &errstr)
+{
+    std::map<uint8_t, uint16_t> codes;
+    bool valid = true;
+    for (std::map<uint8_t, float>::const_iterator it = voltages.begin(); it != voltages.end(); ++it) {
+        if (it->second < FAU201Device::VOLTAGE_MIN || it->second > FAU201Device::VOLTAGE_MAX) {
+            ++errcnt;
+            errstr += "In setVoltages(): Voltage must be between 0 and 4.095.\n";  // Program logic error
+            valid = false;
+        } else {
+            codes[it->first] = FAU201Device::voltageCode(it->second);
+        }
+    }
+    if (valid) {
+        setVoltageCodes(codes, false, errcnt, errstr);
+    }
+}
@@ -0,0 +1,73 @@
+/* FAU201 multi-channel device class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef FAU201MULTIDEVICE_H
+#define FAU201MULTIDEVICE_H
+
+// Includes
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <libusb-1.0/libusb.h>
+#include "fau201device.h"
+
+// Device with several LTC2640 DACs, as found on FAU201 variants, each one connected to a different chip select of the same CP2130
+// Each channel is set up once, with its own SPI mode and delays, and then any number of channels can be updated at once, via a single command batch (see CP2130::executeBatch())
+class FAU201MultiDevice
+{
+private:
+    CP2130 cp2130_;
+    uint16_t channels_;    // Bitmap of the channels that were set up (see setupChannel())
+    uint16_t codesKnown_;  // Bitmap of the channels whose DAC code is known
+    uint16_t codes_[11];   // Last code written to each channel
+    uint16_t settleDelay_;
+
+public:
+    // Class definitions
+    static const int SUCCESS = CP2130::SUCCESS;                  // Returned by open() if successful
+    static const int ERROR_INIT = CP2130::ERROR_INIT;            // Returned by open() in case of a libusb initialization failure
+    static const int ERROR_NOT_FOUND = CP2130::ERROR_NOT_FOUND;  // Returned by open() if the device was not found
+    static const int ERROR_BUSY = CP2130::ERROR_BUSY;            // Returned by open() if the device is already in use
+
+    // Limit applicable to setupChannel() and the voltage setting functions
+    static const uint8_t CHANNEL_MAX = 10;  // Maximum channel, corresponding to the last chip select of the CP2130
+
+    FAU201MultiDevice();
+
+    std::vector<uint8_t> channels() const;
+    bool disconnected() const;
+    uint16_t getSettleDelay() const;
+    bool isChannelSetUp(uint8_t channel) const;
+    bool isOpen() const;
+
+    void close();
+    int open(uint16_t vid, uint16_t pid, const std::string &serial = std::string());
+    int open(libusb_context *context, uint16_t vid, uint16_t pid, const std::string &serial = std::string());
+    int open(USBTransport *transport);
+    void setSettleDelay(uint16_t delay);
+    void setupChannel(uint8_t channel, uint8_t cfrq, const CP2130::SPIDelays &delays, int &errcnt, std::string &errstr);
+    void setVoltage(uint8_t channel, float voltage, int &errcnt, std::string &errstr);
+    void setVoltageCodes(const std::map<uint8_t, uint16_t> &codes, bool force, int &errcnt, std::string &errstr);
+    void setVoltages(const std::map<uint8_t, float> &voltages, int &errcnt, std::string &errstr);
+};
+
+#endif  // FAU201MULTIDEVICE_H
@@ -0,0 +1,405 @@
+/* FAU201 pool class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "fau201pool.h"
+
+// Definitions
+const long EV_POLLPERIOD = 100000;  // Maximum period between checks for a stop request, in microseconds, while handling events
+
+// Private function that returns a pointer to the unit having the given serial number, or a null pointer if no such unit exists (the units mutex must be held)
+FAU201Pool::Unit *FAU201Pool::findUnit(const std::string &serial)
+{
+    Unit *unit = nullptr;
+    for (std::list<Unit>::iterator it = units_.begin(); it != units_.end(); ++it) {
+        if (it->record.serial == serial) {
+            unit = &*it;
+            break;
+        }
+    }
+    return unit;
+}
+
+// Private function that opens a device that has just arrived, and either reopens the matching unit in place or adds a new unit to the pool
+// Returns true if the device was opened, in which case its serial number is assigned to "serial"
+bool FAU201Pool::handleArrival(const HotplugEvent &event, std::string &serial)
+{
+    bool opened = false;
+    std::lock_guard<std::mutex> lock(unitsMutex_);
+    bool known = false;
+    for (std::list<Unit>::iterator it = units_.begin(); it != units_.end(); ++it) {
+        if (it->device.isOpen() && it->record.bus == event.bus && it->record.ports == event.ports) {  // Already in the pool and open (e.g. reported again by the initial enumeration)
+            known = true;
+            break;
+        }
+    }
+    if (!known) {
+        CP2130::DeviceRecord record;
+        record.vid = FAU201Device::VID;
+        record.pid = FAU201Device::PID;
+        record.bus = event.bus;
+        record.ports = event.ports;
+        std::list<Unit> arrival(1);  // Opened separately, since the serial number is only known after the device is opened
+        int errcnt = 0;  // Errors cannot be reported from here, so they only affect the outcome
+        std::string errstr;
+        if (arrival.front().device.open(context_, record) == FAU201Device::SUCCESS) {
+            std::u16string serialDesc = arrival.front().device.getSerialDesc(errcnt, errstr);
+            record.serial.assign(serialDesc.begin(), serialDesc.end());  // Serial numbers are plain ASCII
+            if (errcnt == 0) {
+                Unit *unit = findUnit(record.serial);
+                if (unit == nullptr) {  // New device, which is added to the pool
+                    arrival.front().record = record;
+                    if (setUp_) {
+                        arrival.front().device.setup(errcnt, errstr);
+                        arrival.front().device.setStreamingMode(true, errcnt, errstr);
+                    }
+                    units_.splice(units_.end(), arrival);
+                    opened = true;
+                } else if (!unit->device.isOpen()) {  // Device that left earlier, which is reopened in place, so that pointers returned by device() remain valid
+                    arrival.front().device.close();
+                    unit->record = record;  // The device may have been plugged into another port
+                    if (unit->device.open(context_, record) == FAU201Device::SUCCESS) {
+                        if (hotplugRestore_ && setUp_) {
+                            unit->device.restore(errcnt, errstr);
+                            unit->device.setStreamingMode(true, errcnt, errstr);
+                        }
+                        opened = true;
+                    }
+                }
+            }
+            serial = record.serial;
+        }
+    }
+    return opened;
+}
+
+// Private function that closes the device that has just left, if it is in the pool
+// The unit is kept, so that the device can be reopened in place when it arrives again
+// Returns true if the device was in the pool, in which case its serial number is assigned to "serial"
+bool FAU201Pool::handleDeparture(const HotplugEvent &event, std::string &serial)
+{
+    bool found = false;
+    std::lock_guard<std::mutex> lock(unitsMutex_);
+    for (std::list<Unit>::iterator it = units_.begin(); it != units_.end(); ++it) {
+        if (it->device.isOpen() && it->record.bus == event.bus && it->record.ports == event.ports) {
+            it->device.close();  // Any pending transfers are cancelled
+            serial = it->record.serial;
+            found = true;
+            break;
+        }
+    }
+    return found;
+}
+
+// Private procedure that handles libusb events on behalf of all devices, run by the event handling thread
+void FAU201Pool::handleEvents()
+{
+    while (!stopEvents_) {
+        timeval tv = {0, EV_POLLPERIOD};
+        libusb_handle_events_timeout_completed(context_, &tv, nullptr);
+    }
+}
+
+// Private procedure that processes queued hotplug events, run by the hotplug handling thread
+// Devices cannot be opened or closed from within the hotplug callback itself, hence the need for a separate thread
+void FAU201Pool::handleHotplug()
+{
+    std::unique_lock<std::mutex> lock(hotplugMutex_);
+    while (!stopHotplug_) {
+        hotplugCondition_.wait(lock, [this] { return stopHotplug_ || !hotplugEvents_.empty(); });
+        while (!stopHotplug_ && !hotplugEvents_.empty()) {
+            HotplugEvent event = hotplugEvents_.front();
+            hotplugEvents_.pop_front();
+            lock.unlock();
+            std::string serial;
+            bool notify = event.arrived ? handleArrival(event, serial) : handleDeparture(event, serial);
+            if (notify && hotplugCallback_) {
+                hotplugCallback_(serial, event.arrived);  // The units mutex is not held here, so the callback is free to use the pool
+            }
+            lock.lock();
+        }
+    }
+}
+
+// Static callback invoked by libusb, from within the event handling thread, whenever a matching device arrives or leaves
+// No I/O is done here, since the event is simply queued and processed by the hotplug handling thread
+int LIBUSB_CALL FAU201Pool::hotplugCallback(libusb_context *, libusb_device *device, libusb_hotplug_event event, void *userData)
+{
+    FAU201Pool *pool = static_cast<FAU201Pool *>(userData);
+    HotplugEvent hotplugEvent;
+    hotplugEvent.arrived = event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED;
+    hotplugEvent.bus = libusb_get_bus_number(device);
+    uint8_t ports[7];  // As per the USB 3.0 specification, the current maximum limit for the depth is 7
+    int nports = libusb_get_port_numbers(device, ports, static_cast<int>(sizeof(ports)));
+    if (nports > 0) {
+        hotplugEvent.ports.assign(ports, ports + nports);
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool->hotplugMutex_);
+        pool->hotplugEvents_.push_back(hotplugEvent);
+    }
+    pool->hotplugCondition_.notify_one();
+    return 0;  // Keep the callback registered
+}
+
+FAU201Pool::FAU201Pool() :
+    context_(nullptr),
+    eventThread_(),
+    stopEvents_(false),
+    units_(),
+    unitsMutex_(),
+    setUp_(false),
+    hotplugEnabled_(false),
+    hotplugRestore_(false),
+    stopHotplug_(false),
+    hotplugHandle_(),
+    hotplugCallback_(),
+    hotplugThread_(),
+    hotplugMutex_(),
+    hotplugCondition_(),
+    hotplugEvents_()
+{
+}
+
+FAU201Pool::~FAU201Pool()
+{
+    close();  // The destructor is used to close every device, and this is essential so the devices can be freed when the parent object is destroyed
+}
+
+// Checks if hotplug handling is enabled
+bool FAU201Pool::isHotplugEnabled() const
+{
+    return hotplugEnabled_;
+}
+
+// Checks if the pool is open
+bool FAU201Pool::isOpen() const
+{
+    return context_ != nullptr;  // Returns true if the pool is open, or false otherwise
+}
+
+// Returns the number of devices in the pool
+size_t FAU201Pool::size() const
+{
+    std::lock_guard<std::mutex> lock(unitsMutex_);
+    return units_.size();
+}
+
+// Closes every device in the pool, if open
+void FAU201Pool::close()
+{
+    if (isOpen()) {
+        disableHotplug();
+        std::unique_lock<std::mutex> lock(unitsMutex_);
+        for (std::list<Unit>::iterator it = units_.begin(); it != units_.end(); ++it) {
+            it->device.close();  // Note that the event handling thread must be running at this point, so that any pending transfers can be cancelled
+        }
+        units_.clear();
+        setUp_ = false;
+        lock.unlock();
+        stopEvents_ = true;
+        eventThread_.join();
+        libusb_exit(context_);  // Deinitialize libusb
+        context_ = nullptr;  // Required to mark the pool as closed
+    }
+}
+
+// Returns a pointer to the device having the given serial number, or a null pointer if no such device is in the pool
+// The pointer remains valid until the pool is closed, even if hotplug handling is enabled, since devices that leave are closed but kept in the pool
+// However, while hotplug handling is enabled, the device may be closed or reopened at any time by the hotplug handling thread
+FAU201Device *FAU201Pool::device(const std::string &serial)
+{
+    std::lock_guard<std::mutex> lock(unitsMutex_);
+    Unit *unit = findUnit(serial);
+    return unit == nullptr ? nullptr : &unit->device;
+}
+
+// Disables hotplug handling, if enabled
+void FAU201Pool::disableHotplug()
+{
+    if (hotplugEnabled_) {
+        libusb_hotplug_deregister_callback(context_, hotplugHandle_);
+        {
+            std::lock_guard<std::mutex> lock(hotplugMutex_);
+            stopHotplug_ = true;
+        }
+        hotplugCondition_.notify_one();
+        hotplugThread_.join();
+        hotplugEvents_.clear();  // Events that were not processed are discarded
+        hotplugEnabled_ = false;
+    }
+}
+
+// Enables hotplug handling, so that devices are tracked as they arrive or leave, without polling the bus
+// Devices that leave are closed, while devices that arrive are opened and added to the pool, or reopened in place if they were in the pool before
+// If the pool was set up and "restore" is true, reopened devices are set up again and have their last voltage restored (see FAU201Device::restore())
+// New devices are always set up if the pool was set up. Either way, the given callback (which may be empty) is invoked from the hotplug handling thread
+void FAU201Pool::enableHotplug(bool restore, const HotplugCallback &callback, int &errcnt, std::string &errstr)
+{
+    if (!isOpen()) {
+        ++errcnt;
+        errstr += "In enableHotplug(): Pool is not open.\n";  // Program logic error
+    } else if (libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG) == 0) {
+        ++errcnt;
+        errstr += "Hotplug handling is not supported on this platform.\n";
+    } else if (!hotplugEnabled_) {
+        hotplugRestore_ = restore;
+        hotplugCallback_ = callback;
+        stopHotplug_ = false;
+        hotplugThread_ = std::thread(&FAU201Pool::handleHotplug, this);
+        int events = LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT;
+        if (libusb_hotplug_register_callback(context_, static_cast<libusb_hotplug_event>(events), LIBUSB_HOTPLUG_ENUMERATE, FAU201Device::VID, FAU201Device::PID, LIBUSB_HOTPLUG_MATCH_ANY, hotplugCallback, this, &hotplugHandle_) != LIBUSB_SUCCESS) {  // Devices that are already connected are reported too, so that any device that arrived after open() is not missed
+            {
+                std::lock_guard<std::mutex> lock(hotplugMutex_);
+                stopHotplug_ = true;
+            }
+            hotplugCondition_.notify_one();
+            hotplugThread_.join();
+            hotplugEvents_.clear();
+            ++errcnt;
+            errstr += "Failed to register hotplug callback.\n";
+        } else {
+            hotplugEnabled_ = true;
+        }
+    }
+}
+
+// Opens every FAU201 device that is connected, using a single libusb context and a single event handling thread
+// Devices that cannot be opened are reported via "errcnt" and "errstr", and left out of the pool
+int FAU201Pool::open(int &errcnt, std::string &errstr)
+{
+    int retval;
+    if (isOpen()) {  // Just in case the calling algorithm tries to open a pool that was already open
+        retval = SUCCESS;
+    } else if (libusb_init(&context_) != 0) {  // Initialize libusb. In case of failure
+        context_ = nullptr;
+        retval = ERROR_INIT;
+    } else {  // If libusb is initialized
+        std::vector<CP2130::DeviceRecord> records = FAU201Device::enumerateDevices(context_, errcnt, errstr);  // A single bus scan is required, since each device is then opened directly from its record
+        std::lock_guard<std::mutex> lock(unitsMutex_);
+        for (size_t i = 0; i < records.size(); ++i) {
+            units_.emplace_back();
+            Unit &unit = units_.back();
+            unit.record = records[i];
+            if (unit.device.open(context_, records[i]) != FAU201Device::SUCCESS) {
+                ++errcnt;
+                errstr += "Could not open device with serial number " + records[i].serial + ".\n";
+                units_.pop_back();
+            }
+        }
+        if (units_.empty()) {
+            libusb_exit(context_);  // Deinitialize libusb
+            context_ = nullptr;
+            retval = ERROR_NOT_FOUND;
+        } else {
+            stopEvents_ = false;
+            eventThread_ = std::thread(&FAU201Pool::handleEvents, this);
+            retval = SUCCESS;
+        }
+    }
+    return retval;
+}
+
+// Returns the serial numbers of all devices in the pool
+std::list<std::string> FAU201Pool::serials() const
+{
+    std::list<std::string> serials;
+    std::lock_guard<std::mutex> lock(unitsMutex_);
+    for (std::list<Unit>::const_iterator it = units_.begin(); it != units_.end(); ++it) {
+        serials.push_back(it->record.serial);
+    }
+    return serials;
+}
+
+// Sets up and prepares every device in the pool, leaving all of them in streaming mode
+void FAU201Pool::setup(int &errcnt, std::string &errstr)
+{
+    std::lock_guard<std::mutex> lock(unitsMutex_);
+    for (std::list<Unit>::iterator it = units_.begin(); it != units_.end(); ++it) {
+        if (it->device.isOpen()) {  // Devices that left are set up once they arrive again (see enableHotplug())
+            it->device.setup(errcnt, errstr);
+            it->device.setStreamingMode(true, errcnt, errstr);  // Required by setVoltageAll() and setVoltages()
+        }
+    }
+    setUp_ = true;
+}
+
+// Sets the output voltage of every device in the pool to the given value
+void FAU201Pool::setVoltageAll(float voltage, int &errcnt, std::string &errstr)
+{
+    std::map<std::string, float> voltages;
+    {
+        std::lock_guard<std::mutex> lock(unitsMutex_);
+        for (std::list<Unit>::iterator it = units_.begin(); it != units_.end(); ++it) {
+            if (it->device.isOpen()) {
+                voltages[it->record.serial] = voltage;
+            }
+        }
+    }
+    setVoltages(voltages, errcnt, errstr);
+}
+
+// Sets the output voltage of each device having a serial number in the given map to the corresponding value
+// Updates are submitted to all devices at once, without waiting for each other, and this function returns after all of them complete
+void FAU201Pool::setVoltages(const std::map<std::string, float> &voltages, int &errcnt, std::string &errstr)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t pending = 0;
+    std::list<std::string> failed;
+    std::lock_guard<std::mutex> unitsLock(unitsMutex_);  // Held until all updates complete, so that no device is closed by the hotplug handling thread in the meantime
+    for (std::map<std::string, float>::const_iterator it = voltages.begin(); it != voltages.end(); ++it) {
+        Unit *unit = findUnit(it->first);
+        if (unit == nullptr) {
+            ++errcnt;
+            errstr += "In setVoltages(): Device with serial number " + it->first + " is not in the pool.\n";  // Program logic error
+        } else if (!unit->device.isOpen()) {
+            ++errcnt;
+            errstr += "Device with serial number " + it->first + " is not connected.\n";
+        } else {
+            FAU201Device *target = &unit->device;
+            const std::string *serial = &it->first;
+            int preverrcnt = errcnt;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++pending;
+            }
+            target->setVoltageAsync(it->second, [&, serial](int status, int) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (status != LIBUSB_TRANSFER_COMPLETED) {
+                    failed.push_back(*serial);
+                }
+                --pending;
+                condition.notify_one();
+            }, errcnt, errstr);
+            if (errcnt != preverrcnt) {  // The update was not submitted, and the error is already reported
+                std::lock_guard<std::mutex> lock(mutex);
+                --pending;
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return pending == 0; });  // Wait for all updates to complete
+    for (std::list<std::string>::iterator it = failed.begin(); it != failed.end(); ++it) {
+        ++errcnt;
+        errstr += "Failed to set the voltage of device with serial number " + *it + ".\n";
+    }
+}
@@ -0,0 +1,102 @@
+/* FAU201 pool class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef FAU201POOL_H
+#define FAU201POOL_H
+
+// Includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <libusb-1.0/libusb.h>
+#include "fau201device.h"
+
+class FAU201Pool
+{
+private:
+    struct Unit {
+        CP2130::DeviceRecord record;  // Record describing the device, including its serial number
+        FAU201Device device;          // Device object
+    };
+
+    struct HotplugEvent {
+        bool arrived;                // True if the device arrived, or false if it left
+        uint8_t bus;                 // Bus number
+        std::vector<uint8_t> ports;  // Port path
+    };
+
+    libusb_context *context_;
+    std::thread eventThread_;
+    std::atomic<bool> stopEvents_;
+    std::list<Unit> units_;
+    mutable std::mutex unitsMutex_;
+    bool setUp_;
+    bool hotplugEnabled_, hotplugRestore_, stopHotplug_;
+    libusb_hotplug_callback_handle hotplugHandle_;
+    std::function<void(const std::string &serial, bool arrived)> hotplugCallback_;
+    std::thread hotplugThread_;
+    std::mutex hotplugMutex_;
+    std::condition_variable hotplugCondition_;
+    std::deque<HotplugEvent> hotplugEvents_;
+
+    Unit *findUnit(const std::string &serial);
+    bool handleArrival(const HotplugEvent &event, std::string &serial);
+    bool handleDeparture(const HotplugEvent &event, std::string &serial);
+    void handleEvents();
+    void handleHotplug();
+
+    static int LIBUSB_CALL hotplugCallback(libusb_context *context, libusb_device *device, libusb_hotplug_event event, void *userData);
+
+public:
+    // Class definitions
+    static const int SUCCESS = FAU201Device::SUCCESS;                  // Returned by open() if successful
+    static const int ERROR_INIT = FAU201Device::ERROR_INIT;            // Returned by open() in case of a libusb initialization failure
+    static const int ERROR_NOT_FOUND = FAU201Device::ERROR_NOT_FOUND;  // Returned by open() if no devices could be opened
+
+    // Callback invoked by the hotplug handling thread whenever a device arrives or leaves (see enableHotplug())
+    typedef std::function<void(const std::string &serial, bool arrived)> HotplugCallback;
+
+    FAU201Pool();
+    ~FAU201Pool();
+
+    bool isHotplugEnabled() const;
+    bool isOpen() const;
+    size_t size() const;
+
+    void close();
+    void disableHotplug();
+    void enableHotplug(bool restore, const HotplugCallback &callback, int &errcnt, std::string &errstr);
+    FAU201Device *device(const std::string &serial);
+    int open(int &errcnt, std::string &errstr);
+    std::list<std::string> serials() const;
+    void setup(int &errcnt, std::string &errstr);
+    void setVoltageAll(float voltage, int &errcnt, std::string &errstr);
+    void setVoltages(const std::map<std::string, float> &voltages, int &errcnt, std::string &errstr);
+};
+
+#endif  // FAU201POOL_H
@@ -0,0 +1,278 @@
+/* FAU201 scheduler class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include "fau201scheduler.h"
+
+// Private function that returns the deadline of the code of the given profile at the given index
+std::chrono::steady_clock::time_point FAU201Scheduler::deadline(const Profile &profile, size_t index)
+{
+    return profile.start + profile.period * static_cast<std::chrono::microseconds::rep>(index);
+}
+
+// Private procedure run by the worker thread, which writes every code that is due, and then sleeps until the next deadline
+// The mutex is held while writing, so that a profile that is cancelled causes no further updates once cancel() returns
+void FAU201Scheduler::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::time_point::max();
+        std::list<Profile>::iterator it = profiles_.begin();
+        while (it != profiles_.end()) {
+            if (deadline(*it, it->next) <= now) {
+                update(*it, now);
+            }
+            if (it->next == it->codes.size()) {  // Profile completed
+                it = profiles_.erase(it);
+                condition_.notify_all();  // See wait()
+            } else {
+                next = std::min(next, deadline(*it, it->next));
+                ++it;
+            }
+        }
+        if (profiles_.empty()) {
+            condition_.wait(lock);
+        } else {
+            condition_.wait_until(lock, next);
+        }
+    }
+}
+
+// Private procedure that writes the latest code of the given profile that is due, skipping any earlier ones, so that a late profile catches up instead of falling further behind
+void FAU201Scheduler::update(Profile &profile, std::chrono::steady_clock::time_point now)
+{
+    size_t due = std::min(static_cast<size_t>((now - profile.start) / profile.period), profile.codes.size() - 1);
+    skipped_ += due - profile.next;
+    profile.next = due + 1;
+    uint64_t lateness = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - deadline(profile, due)).count());
+    if (lateness > static_cast<uint64_t>(tolerance_.count())) {
+        ++missed_;
+    }
+    if (lateness > maxLateness_) {
+        maxLateness_ = lateness;  // Only the worker thread writes this value, other than resetStats()
+    }
+    CP2130::Status status = profile.device->setVoltageCode(profile.codes[due]);
+    ++updates_;
+    if (status.code != CP2130::STATUS_OK) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        ++errcnt_;
+        errstr_ += status.message();
+    }
+}
+
+// "Equal to" operator for Stats
+bool FAU201Scheduler::Stats::operator ==(const FAU201Scheduler::Stats &other) const
+{
+    return updates == other.updates && missedDeadlines == other.missedDeadlines && skippedCodes == other.skippedCodes && maxLateness == other.maxLateness;
+}
+
+// "Not equal to" operator for Stats
+bool FAU201Scheduler::Stats::operator !=(const FAU201Scheduler::Stats &other) const
+{
+    return !(operator ==(other));
+}
+
+// A code is considered to miss its deadline if written later than the given tolerance
+FAU201Scheduler::FAU201Scheduler(std::chrono::microseconds tolerance) :
+    tolerance_(tolerance),
+    profiles_(),
+    mutex_(),
+    condition_(),
+    updates_(0),
+    missed_(0),
+    skipped_(0),
+    maxLateness_(0),
+    running_(false),
+    stop_(false),
+    thread_(),
+    errorMutex_(),
+    errcnt_(0),
+    errstr_()
+{
+}
+
+FAU201Scheduler::~FAU201Scheduler()
+{
+    stop();
+}
+
+// Returns a snapshot of the statistics gathered so far
+FAU201Scheduler::Stats FAU201Scheduler::getStats() const
+{
+    Stats stats;
+    stats.updates = updates_;
+    stats.missedDeadlines = missed_;
+    stats.skippedCodes = skipped_;
+    stats.maxLateness = maxLateness_;
+    return stats;
+}
+
+// Checks if the worker thread is running
+bool FAU201Scheduler::isRunning() const
+{
+    return running_;
+}
+
+// Checks if a profile is in progress for the given device
+bool FAU201Scheduler::isScheduled(const FAU201Device &device) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool scheduled = false;
+    for (std::list<Profile>::const_iterator it = profiles_.begin(); it != profiles_.end(); ++it) {
+        if (it->device == &device) {
+            scheduled = true;
+            break;
+        }
+    }
+    return scheduled;
+}
+
+// Cancels the profile in progress for the given device, if any, leaving the device at the last code written
+void FAU201Scheduler::cancel(const FAU201Device &device)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::list<Profile>::iterator it = profiles_.begin(); it != profiles_.end(); ++it) {
+        if (it->device == &device) {
+            profiles_.erase(it);
+            break;
+        }
+    }
+    condition_.notify_all();
+}
+
+// Appends to "errcnt" and "errstr" the errors reported by the worker thread since the last call, clearing them afterwards
+void FAU201Scheduler::collectErrors(int &errcnt, std::string &errstr)
+{
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    errcnt += errcnt_;
+    errstr += errstr_;
+    errcnt_ = 0;
+    errstr_.clear();
+}
+
+// Clears the statistics gathered so far
+void FAU201Scheduler::resetStats()
+{
+    updates_ = 0;
+    missed_ = 0;
+    skipped_ = 0;
+    maxLateness_ = 0;
+}
+
+// Schedules the given codes to be written to the given device, one per period, starting right away, and replacing any profile in progress for the same device
+// Redundant codes cost no transfers, since the device skips them (see FAU201Device::setVoltageCode())
+void FAU201Scheduler::schedule(FAU201Device &device, const std::vector<uint16_t> &codes, std::chrono::microseconds period, int &errcnt, std::string &errstr)
+{
+    if (codes.empty()) {
+        ++errcnt;
+        errstr += "In schedule(): Profile is empty.\n";  // Program logic error
+    } else if (*std::max_element(codes.begin(), codes.end()) > FAU201Device::CODE_MAX) {
+        ++errcnt;
+        errstr += "In schedule(): Codes must be between 0 and 4095.\n";  // Program logic error
+    } else if (period.count() <= 0) {
+        ++errcnt;
+        errstr += "In schedule(): Period must be greater than zero.\n";  // Program logic error
+    } else {
+        Profile profile;
+        profile.device = &device;
+        profile.codes = codes;
+        profile.period = period;
+        profile.next = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::list<Profile>::iterator it = profiles_.begin(); it != profiles_.end(); ++it) {
+            if (it->device == &device) {
+                profiles_.erase(it);
+                break;
+            }
+        }
+        profile.start = std::chrono::steady_clock::now();
+        profiles_.push_back(profile);
+        condition_.notify_all();
+    }
+}
+
+// Schedules the given ramp to be played on the given device, sampled once every period (see the previous function)
+void FAU201Scheduler::schedule(FAU201Device &device, const FAU201Device::Ramp &ramp, std::chrono::microseconds period, int &errcnt, std::string &errstr)
+{
+    if (ramp.duration.count() <= 0) {
+        ++errcnt;
+        errstr += "In schedule(): Duration must be greater than zero.\n";  // Program logic error
+    } else if (period.count() <= 0) {
+        ++errcnt;
+        errstr += "In schedule(): Period must be greater than zero.\n";  // Program logic error
+    } else {
+        int preverrcnt = errcnt;
+        size_t steps = static_cast<size_t>(ramp.duration / period) + 1;  // Both the start and end voltages are included
+        std::vector<uint16_t> codes = FAU201Device::rampCodes(ramp, std::max(steps, static_cast<size_t>(2)), errcnt, errstr);
+        if (errcnt == preverrcnt) {
+            schedule(device, codes, period, errcnt, errstr);
+        }
+    }
+}
+
+// Starts the worker thread, and sets its priority to the given realtime priority, using the SCHED_FIFO policy, unless the priority is zero
+// Failing to set the priority, which usually requires privileges, is reported as an error, but the thread keeps running with normal priority
+void FAU201Scheduler::start(int priority, int &errcnt, std::string &errstr)
+{
+    if (running_) {
+        ++errcnt;
+        errstr += "In start(): Scheduler is already running.\n";  // Program logic error
+    } else {
+        stop_ = false;
+        running_ = true;
+        thread_ = std::thread(&FAU201Scheduler::run, this);
+        if (priority != 0) {
+            sched_param param;
+            param.sched_priority = priority;
+            if (pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &param) != 0) {
+                ++errcnt;
+                errstr += "Failed to set the realtime priority of the worker thread.\n";
+            }
+        }
+    }
+}
+
+// Stops the worker thread, if running, discarding any profiles in progress
+void FAU201Scheduler::stop()
+{
+    if (running_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            profiles_.clear();
+        }
+        condition_.notify_all();
+        thread_.join();
+        running_ = false;
+    }
+}
+
+// Blocks until every profile in progress is completed or cancelled
+// If the worker thread is not running, this returns immediately
+void FAU201Scheduler::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return profiles_.empty() || !running_; });
+}
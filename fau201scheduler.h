@@ -0,0 +1,99 @@
+/* FAU201 scheduler class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef FAU201SCHEDULER_H
+#define FAU201SCHEDULER_H
+
+// Includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fau201device.h"
+
+// Worker that plays setpoint profiles on any number of FAU201 devices, from a single thread that can be given realtime priority
+// Each profile is a sequence of DAC codes, one per period, and every update is tracked against its deadline
+// Unlike FAU201Device::playRamp(), profiles are paced by the host, but they do not block the caller, and any number of devices can be served at once
+// While a profile is in progress, its device must not be accessed other than through this class
+class FAU201Scheduler
+{
+private:
+    struct Profile {
+        FAU201Device *device;                         // Device to which the profile applies
+        std::vector<uint16_t> codes;                  // DAC codes to be written, one per period
+        std::chrono::microseconds period;             // Period between consecutive codes
+        std::chrono::steady_clock::time_point start;  // Deadline of the first code
+        size_t next;                                  // Index of the next code to be written
+    };
+
+    std::chrono::microseconds tolerance_;
+    std::list<Profile> profiles_;
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::atomic<uint64_t> updates_, missed_, skipped_, maxLateness_;
+    std::atomic<bool> running_;
+    bool stop_;
+    std::thread thread_;
+    std::mutex errorMutex_;
+    int errcnt_;
+    std::string errstr_;
+
+    void run();
+    void update(Profile &profile, std::chrono::steady_clock::time_point now);
+
+    static std::chrono::steady_clock::time_point deadline(const Profile &profile, size_t index);
+
+public:
+    // Statistics, as returned by getStats()
+    struct Stats {
+        uint64_t updates;          // Number of codes written
+        uint64_t missedDeadlines;  // Number of codes written later than the tolerance given to the constructor
+        uint64_t skippedCodes;     // Number of codes that were not written at all, because a later code was already due
+        uint64_t maxLateness;      // Maximum lateness of a code, in microseconds
+
+        bool operator ==(const Stats &other) const;
+        bool operator !=(const Stats &other) const;
+    };
+
+    explicit FAU201Scheduler(std::chrono::microseconds tolerance = std::chrono::microseconds(500));
+    ~FAU201Scheduler();
+
+    Stats getStats() const;
+    bool isRunning() const;
+    bool isScheduled(const FAU201Device &device) const;
+
+    void cancel(const FAU201Device &device);
+    void collectErrors(int &errcnt, std::string &errstr);
+    void resetStats();
+    void schedule(FAU201Device &device, const std::vector<uint16_t> &codes, std::chrono::microseconds period, int &errcnt, std::string &errstr);
+    void schedule(FAU201Device &device, const FAU201Device::Ramp &ramp, std::chrono::microseconds period, int &errcnt, std::string &errstr);
+    void start(int priority, int &errcnt, std::string &errstr);
+    void stop();
+    void wait();
+};
+
+#endif  // FAU201SCHEDULER_H
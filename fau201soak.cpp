@@ -0,0 +1,302 @@
+/* FAU201 soak test class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <unistd.h>
+#include "fau201soak.h"
+
+// Definitions
+const size_t SOAK_SUBBINS = 16;              // Number of latency histogram bins per octave, above the first SOAK_SUBBINS microseconds, which get a bin each
+const size_t SOAK_SUBBITS = 4;               // Number of bits needed to index the above bins
+const size_t SOAK_BINS = SOAK_SUBBINS * 61;  // Number of latency histogram bins, which are enough to cover every 64-bit latency
+const size_t SOAK_SEQUENCELENGTH = 64;       // Number of frames of each sequence, which sweeps the whole DAC range
+
+// Private function that returns the given fraction of the update latency, rounded up to the upper bound of its histogram bin, and never above the maximum latency
+uint64_t FAU201Soak::percentile(double fraction) const
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < SOAK_BINS; ++i) {
+        total += histogram_[i].load(std::memory_order_relaxed);
+    }
+    uint64_t latency = 0;
+    if (total != 0) {
+        uint64_t rank = std::max(static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total))), static_cast<uint64_t>(1));
+        uint64_t count = 0;
+        for (size_t i = 0; i < SOAK_BINS; ++i) {
+            count += histogram_[i].load(std::memory_order_relaxed);
+            if (count >= rank) {
+                latency = std::min(latencyBound(i), maxLatency_.load());
+                break;
+            }
+        }
+    }
+    return latency;
+}
+
+// Private procedure that accounts for an update with the given latency, in microseconds
+void FAU201Soak::record(uint64_t latency)
+{
+    histogram_[latencyBin(latency)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = maxLatency_.load();
+    while (latency > max && !maxLatency_.compare_exchange_weak(max, latency)) {  // Several worker threads can update this value
+    }
+}
+
+// Private procedure run by each worker thread, which updates its devices in turn, as fast as they allow, and plays a sequence on each of them once every few rounds
+// Codes alternate between rounds, so that no update is skipped as redundant (see FAU201Device::setVoltageCode())
+// A device that becomes disconnected is accounted for once, and no longer accessed, and the thread returns once every device is disconnected
+void FAU201Soak::run(Worker &worker)
+{
+    size_t active = worker.devices.size();
+    uint64_t round = 0;
+    while (!stop_ && active != 0) {
+        uint16_t code = (round & 1) == 0 ? FAU201Device::CODE_MAX : 0;
+        bool playing = sequenceEvery_ != 0 && round % sequenceEvery_ == sequenceEvery_ - 1;
+        for (size_t i = 0; i < worker.devices.size() && !stop_; ++i) {
+            if (!worker.disconnected[i]) {
+                FAU201Device &device = *worker.devices[i];
+                std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+                CP2130::Status status = device.setVoltageCode(code);
+                record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before).count()));
+                ++updates_;
+                if (status.code != CP2130::STATUS_OK) {
+                    ++errors_;
+                }
+                if (playing && status.code == CP2130::STATUS_OK) {
+                    int errcnt = 0;
+                    std::string errstr;
+                    device.playSequence(sequence_, 0, errcnt, errstr);
+                    ++sequences_;
+                    if (errcnt != 0) {
+                        ++errors_;
+                    }
+                }
+                if (device.disconnected()) {
+                    worker.disconnected[i] = true;
+                    ++disconnects_;
+                    --active;
+                }
+            }
+        }
+        ++round;
+    }
+}
+
+// Private helper function that returns the latency histogram bin corresponding to the given latency, in microseconds
+// Latencies below SOAK_SUBBINS get a bin each, and every octave above is split into SOAK_SUBBINS bins, according to the bits that follow the leading one
+size_t FAU201Soak::latencyBin(uint64_t latency)
+{
+    size_t bin;
+    if (latency < SOAK_SUBBINS) {
+        bin = static_cast<size_t>(latency);
+    } else {
+        size_t octave = SOAK_SUBBITS;
+        while ((latency >> (octave + 1)) != 0) {
+            ++octave;
+        }
+        bin = SOAK_SUBBINS * (octave - SOAK_SUBBITS + 1) + static_cast<size_t>((latency >> (octave - SOAK_SUBBITS)) & (SOAK_SUBBINS - 1));
+    }
+    return bin;
+}
+
+// Private helper function that returns the highest latency, in microseconds, that corresponds to the given latency histogram bin (see latencyBin())
+uint64_t FAU201Soak::latencyBound(size_t bin)
+{
+    uint64_t bound;
+    if (bin < SOAK_SUBBINS) {
+        bound = static_cast<uint64_t>(bin);
+    } else {
+        size_t shift = bin / SOAK_SUBBINS - 1;
+        bound = ((static_cast<uint64_t>(SOAK_SUBBINS + bin % SOAK_SUBBINS) + 1) << shift) - 1;
+    }
+    return bound;
+}
+
+// Private helper function that returns the resident memory of the process, in bytes, or -1 if not available
+// This relies on the "/proc" filesystem, as found on Linux
+long FAU201Soak::residentMemory()
+{
+    long memory = -1;
+    std::ifstream statm("/proc/self/statm");
+    long size, resident;
+    if (statm >> size >> resident) {
+        memory = resident * sysconf(_SC_PAGESIZE);
+    }
+    return memory;
+}
+
+// "Equal to" operator for Report
+bool FAU201Soak::Report::operator ==(const FAU201Soak::Report &other) const
+{
+    return elapsed == other.elapsed && updates == other.updates && sequences == other.sequences && errors == other.errors && disconnects == other.disconnects && rate == other.rate && p50 == other.p50 && p99 == other.p99 && p999 == other.p999 && maxLatency == other.maxLatency && memoryGrowth == other.memoryGrowth;
+}
+
+// "Not equal to" operator for Report
+bool FAU201Soak::Report::operator !=(const FAU201Soak::Report &other) const
+{
+    return !(operator ==(other));
+}
+
+FAU201Soak::FAU201Soak() :
+    devices_(),
+    workers_(),
+    sequenceEvery_(0),
+    sequence_(),
+    histogram_(SOAK_BINS),
+    updates_(0),
+    sequences_(0),
+    errors_(0),
+    disconnects_(0),
+    maxLatency_(0),
+    running_(false),
+    stop_(false),
+    start_(),
+    end_(),
+    startMemory_(-1),
+    endMemory_(-1),
+    timeMutex_()
+{
+    for (size_t i = 0; i < SOAK_BINS; ++i) {
+        histogram_[i] = 0;
+    }
+    for (size_t i = 0; i < SOAK_SEQUENCELENGTH; ++i) {
+        sequence_.push_back(FAU201Device::codeFrame(static_cast<uint16_t>(FAU201Device::CODE_MAX * i / (SOAK_SEQUENCELENGTH - 1))));
+    }
+}
+
+FAU201Soak::~FAU201Soak()
+{
+    stop();
+}
+
+// Returns a snapshot of the results gathered since the soak test was started, which can be taken while it runs
+FAU201Soak::Report FAU201Soak::getReport() const
+{
+    Report report;
+    {
+        std::lock_guard<std::mutex> lock(timeMutex_);
+        std::chrono::steady_clock::time_point end = running_ ? std::chrono::steady_clock::now() : end_;
+        report.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start_);
+        long memory = running_ ? residentMemory() : endMemory_;
+        report.memoryGrowth = memory < 0 || startMemory_ < 0 ? 0 : memory - startMemory_;
+    }
+    report.updates = updates_;
+    report.sequences = sequences_;
+    report.errors = errors_;
+    report.disconnects = disconnects_;
+    report.rate = report.elapsed.count() <= 0 ? 0.0 : 1000000.0 * static_cast<double>(report.updates) / static_cast<double>(report.elapsed.count());
+    report.p50 = percentile(0.5);
+    report.p99 = percentile(0.99);
+    report.p999 = percentile(0.999);
+    report.maxLatency = maxLatency_;
+    return report;
+}
+
+// Checks if the soak test is running, that is, if start() was called and stop() was not called since
+// This remains true even if every device is found to be disconnected
+bool FAU201Soak::isRunning() const
+{
+    return running_;
+}
+
+// Adds the given device, which must be open, to the set of devices to be exercised
+// Devices can be real FAU201 boards, as opened from the serial numbers returned by FAU201Device::listDevices(), or simulated ones (see CP2130Simulator)
+void FAU201Soak::addDevice(FAU201Device &device, int &errcnt, std::string &errstr)
+{
+    if (running_) {
+        ++errcnt;
+        errstr += "In addDevice(): Soak test is already running.\n";  // Program logic error
+    } else if (!device.isOpen()) {
+        ++errcnt;
+        errstr += "In addDevice(): device is not open.\n";  // Program logic error
+    } else if (std::find(devices_.begin(), devices_.end(), &device) != devices_.end()) {
+        ++errcnt;
+        errstr += "In addDevice(): Device was already added.\n";  // Program logic error
+    } else {
+        devices_.push_back(&device);
+    }
+}
+
+// Starts the soak test, sharing the devices among the given number of worker threads, each device being served by a single thread, since FAU201Device is not thread-safe
+// A sequence is played on each device once every "sequenceEvery" updates, or never, if zero, and the results of any previous run are cleared
+void FAU201Soak::start(size_t threads, size_t sequenceEvery, int &errcnt, std::string &errstr)
+{
+    if (running_) {
+        ++errcnt;
+        errstr += "In start(): Soak test is already running.\n";  // Program logic error
+    } else if (devices_.empty()) {
+        ++errcnt;
+        errstr += "In start(): No devices were added.\n";  // Program logic error
+    } else if (threads == 0) {
+        ++errcnt;
+        errstr += "In start(): Number of threads must be greater than zero.\n";  // Program logic error
+    } else {
+        sequenceEvery_ = sequenceEvery;
+        for (size_t i = 0; i < SOAK_BINS; ++i) {
+            histogram_[i] = 0;
+        }
+        updates_ = 0;
+        sequences_ = 0;
+        errors_ = 0;
+        disconnects_ = 0;
+        maxLatency_ = 0;
+        stop_ = false;
+        workers_.clear();
+        workers_.resize(std::min(threads, devices_.size()));  // Threads without devices would be useless
+        std::list<Worker>::iterator worker = workers_.begin();
+        for (size_t i = 0; i < devices_.size(); ++i) {
+            worker->devices.push_back(devices_[i]);
+            worker->disconnected.push_back(false);
+            if (++worker == workers_.end()) {
+                worker = workers_.begin();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(timeMutex_);
+            startMemory_ = residentMemory();
+            start_ = std::chrono::steady_clock::now();
+            running_ = true;
+        }
+        for (std::list<Worker>::iterator it = workers_.begin(); it != workers_.end(); ++it) {
+            it->thread = std::thread(&FAU201Soak::run, this, std::ref(*it));
+        }
+    }
+}
+
+// Stops the soak test, if running, waiting for every worker thread to return
+// The results are kept, and can still be obtained by getReport()
+void FAU201Soak::stop()
+{
+    if (running_) {
+        stop_ = true;
+        for (std::list<Worker>::iterator it = workers_.begin(); it != workers_.end(); ++it) {
+            it->thread.join();
+        }
+        std::lock_guard<std::mutex> lock(timeMutex_);
+        end_ = std::chrono::steady_clock::now();
+        endMemory_ = residentMemory();
+        running_ = false;
+    }
+}
@@ -0,0 +1,97 @@
+/* FAU201 soak test class - Version 1.0.0
+   Requires FAU201 device class version 1.1.0 or later
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef FAU201SOAK_H
+#define FAU201SOAK_H
+
+// Includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fau201device.h"
+
+// Load generator that hammers any number of FAU201 devices with voltage updates and sequence playback, from several threads, for as long as required
+// The devices are shared among the threads, so that each device is only accessed by one of them, and they can be real or simulated (see CP2130Simulator)
+// Latencies are gathered into a log-linear histogram, whose resolution is within 1/16 of each value, so that high percentiles remain meaningful over hours of operation
+// While running, the devices must not be accessed other than through this class
+class FAU201Soak
+{
+private:
+    struct Worker {
+        std::vector<FAU201Device *> devices;  // Devices served by the thread
+        std::vector<bool> disconnected;       // Devices found to be disconnected, which are no longer accessed
+        std::thread thread;                   // Worker thread
+    };
+
+    std::vector<FAU201Device *> devices_;
+    std::list<Worker> workers_;
+    size_t sequenceEvery_;
+    std::vector<FAU201Device::Frame> sequence_;
+    std::vector<std::atomic<uint64_t>> histogram_;
+    std::atomic<uint64_t> updates_, sequences_, errors_, disconnects_, maxLatency_;
+    std::atomic<bool> running_, stop_;
+    std::chrono::steady_clock::time_point start_, end_;
+    long startMemory_, endMemory_;
+    mutable std::mutex timeMutex_;
+
+    uint64_t percentile(double fraction) const;
+    void record(uint64_t latency);
+    void run(Worker &worker);
+
+    static size_t latencyBin(uint64_t latency);
+    static uint64_t latencyBound(size_t bin);
+    static long residentMemory();
+
+public:
+    // Report, as returned by getReport()
+    struct Report {
+        std::chrono::microseconds elapsed;  // Time elapsed since the soak test was started, up to when it was stopped, if applicable
+        uint64_t updates;                   // Number of voltage updates
+        uint64_t sequences;                 // Number of sequences played
+        uint64_t errors;                    // Number of failed updates and sequences
+        uint64_t disconnects;               // Number of devices found to be disconnected (see FAU201Device::disconnected())
+        double rate;                        // Sustained update rate, in updates per second
+        uint64_t p50, p99, p999;            // Median, 99th and 99.9th percentiles of the update latency, in microseconds (upper bounds of the corresponding histogram bins)
+        uint64_t maxLatency;                // Maximum update latency, in microseconds
+        long memoryGrowth;                  // Growth of the resident memory of the process since the soak test was started, up to when it was stopped, if applicable, in bytes (zero if not available)
+
+        bool operator ==(const Report &other) const;
+        bool operator !=(const Report &other) const;
+    };
+
+    FAU201Soak();
+    ~FAU201Soak();
+
+    Report getReport() const;
+    bool isRunning() const;
+
+    void addDevice(FAU201Device &device, int &errcnt, std::string &errstr);
+    void start(size_t threads, size_t sequenceEvery, int &errcnt, std::string &errstr);
+    void stop();
+};
+
+#endif  // FAU201SOAK_H
@@ -1,5 +1,5 @@
-/* Extra functions for libusb - Version 1.0.3
-   Copyright (c) 2018-2021 Samuel Lourenço
+/* Extra functions for libusb - Version 1.1.0
+   Copyright (c) 2018-2026 Samuel Lourenço
 
    This library is free software: you can redistribute it and/or modify it
    under the terms of the GNU Lesser General Public License as published by
@@ -22,6 +22,30 @@
 #include <string.h>
 #include "libusb-extra.h"
 
+// Opens the device with matching VID, PID, bus number and port path (added in version 1.1.0)
+// Unlike libusb_open_device_with_vid_pid_serial(), only the matching device is opened
+libusb_device_handle *libusb_open_device_with_vid_pid_path(libusb_context *context, uint16_t vid, uint16_t pid, uint8_t bus, const uint8_t *ports, int nports)
+{
+    libusb_device **devs;
+    libusb_device_handle *devhandle = NULL;
+    if (libusb_get_device_list(context, &devs) >= 0) {  // If the device list is retrieved
+        libusb_device *dev;
+        size_t devcounter = 0;
+        while ((dev = devs[devcounter++]) != NULL) {  // Walk through all the devices
+            struct libusb_device_descriptor desc;
+            uint8_t devports[7];  // As per the USB 3.0 specification, the current maximum limit for the depth is 7
+            if (libusb_get_bus_number(dev) == bus && libusb_get_port_numbers(dev, devports, (int)sizeof(devports)) == nports && memcmp(devports, ports, (size_t)nports) == 0) {  // If both the bus number and the port path match
+                if (libusb_get_device_descriptor(dev, &desc) == 0 && desc.idVendor == vid && desc.idProduct == pid && libusb_open(dev, &devhandle) != 0) {  // If the device descriptor is retrieved and both PID and VID match, but the device cannot be opened
+                    devhandle = NULL;  // Set device handle value to null pointer
+                }
+                break;  // No other device can have the same bus number and port path
+            }
+        }
+        libusb_free_device_list(devs, 1);  // Free device list
+    }
+    return devhandle;  // Return device handle (or null pointer if no matching device was found)
+}
+
 // Opens the device with matching VID, PID and serial number
 libusb_device_handle *libusb_open_device_with_vid_pid_serial(libusb_context *context, uint16_t vid, uint16_t pid, unsigned char *serial)
 {
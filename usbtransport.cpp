@@ -0,0 +1,68 @@
+/* USB transport classes - Version 1.0.0
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "usbtransport.h"
+
+USBTransport::~USBTransport()
+{
+}
+
+// Clears the halt condition of the given endpoint, which is not supported unless reimplemented
+int USBTransport::clearHalt(uint8_t endpointAddr)
+{
+    (void)endpointAddr;
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+}
+
+LibUSBTransport::LibUSBTransport(libusb_device_handle *handle) :
+    handle_(handle)
+{
+}
+
+// Returns the device handle in use
+libusb_device_handle *LibUSBTransport::handle() const
+{
+    return handle_;
+}
+
+// Carries out a bulk transfer via libusb_bulk_transfer()
+int LibUSBTransport::bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    return libusb_bulk_transfer(handle_, endpointAddr, data, length, transferred, timeout);
+}
+
+// Clears the halt condition of the given endpoint via libusb_clear_halt()
+int LibUSBTransport::clearHalt(uint8_t endpointAddr)
+{
+    return libusb_clear_halt(handle_, endpointAddr);
+}
+
+// Carries out a control transfer via libusb_control_transfer()
+int LibUSBTransport::controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, unsigned int timeout)
+{
+    return libusb_control_transfer(handle_, bmRequestType, bRequest, wValue, wIndex, data, wLength, timeout);
+}
+
+// Sets the device handle to be used by subsequent transfers
+void LibUSBTransport::setHandle(libusb_device_handle *handle)
+{
+    handle_ = handle;
+}
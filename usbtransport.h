@@ -0,0 +1,58 @@
+/* USB transport classes - Version 1.0.0
+   Copyright (c) 2026 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef USBTRANSPORT_H
+#define USBTRANSPORT_H
+
+// Includes
+#include <cstdint>
+#include <libusb-1.0/libusb.h>
+
+// Interface used by the CP2130 class for synchronous control and bulk transfers
+// Both functions follow the conventions of libusb_control_transfer() and libusb_bulk_transfer(), including the returned error codes, so that any implementation can be used in place of libusb
+// Likewise, clearHalt() follows the conventions of libusb_clear_halt(), but it does not need to be implemented
+class USBTransport
+{
+public:
+    virtual ~USBTransport();
+
+    virtual int bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout) = 0;
+    virtual int clearHalt(uint8_t endpointAddr);
+    virtual int controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, unsigned int timeout) = 0;
+};
+
+// Transport that carries out transfers via libusb, using the given device handle (which is not owned by the transport)
+class LibUSBTransport : public USBTransport
+{
+private:
+    libusb_device_handle *handle_;
+
+public:
+    explicit LibUSBTransport(libusb_device_handle *handle = nullptr);
+
+    libusb_device_handle *handle() const;
+
+    int bulkTransfer(uint8_t endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout) override;
+    int clearHalt(uint8_t endpointAddr) override;
+    int controlTransfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, unsigned char *data, uint16_t wLength, unsigned int timeout) override;
+    void setHandle(libusb_device_handle *handle);
+};
+
+#endif  // USBTRANSPORT_H